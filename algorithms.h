@@ -1,8 +1,51 @@
 #ifndef ALGORITHMS_H_
 #define ALGORITHMS_H_
 
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
 #include <iterator>
-#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.h"
+
+namespace execution {
+
+// Runs the plain loop.
+struct SequentialPolicy {};
+// Splits a random-access range into chunks for the default ThreadPool.
+struct ParallelPolicy {};
+// Walks a contiguous range of arithmetic values in blocks of independent
+// lanes that the compiler turns into SIMD code. Predicates may be called on
+// a whole block past the first match, and sums may be reassociated.
+struct VectorizedPolicy {};
+
+inline constexpr SequentialPolicy kSequential{};
+inline constexpr ParallelPolicy kParallel{};
+inline constexpr VectorizedPolicy kVectorized{};
+
+template<typename Policy>
+concept ExecutionPolicy =
+    std::same_as<std::remove_cvref_t<Policy>, SequentialPolicy> ||
+    std::same_as<std::remove_cvref_t<Policy>, ParallelPolicy> ||
+    std::same_as<std::remove_cvref_t<Policy>, VectorizedPolicy>;
+
+}  // namespace execution
+
+// How Accumulate sums values of type T. Types with a cheaper way to add
+// many values specialize it, as BigInteger does with its batch accumulator.
+template<typename T>
+struct Accumulation {
+  using Partial = T;
+
+  static T Total(Partial& partial) {
+    return std::move(partial);
+  }
+};
 
 template<typename Iterator>
 bool IsSorted(Iterator begin, Iterator end) {
@@ -41,40 +84,45 @@ Iterator MaxElement(Iterator begin, Iterator end) {
 template<typename Iterator>
 typename std::iterator_traits<Iterator>::value_type
 Accumulate(Iterator begin, Iterator end) {
-  typename std::iterator_traits<Iterator>::value_type accumulator{};
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  typename Accumulation<Value>::Partial accumulator{};
   for (Iterator iter{begin}; iter != end; ++iter) {
     accumulator += *iter;
   }
-  return accumulator;
+  return Accumulation<Value>::Total(accumulator);
+}
+// Adds the range to init with +=, so that an accumulator such as
+// BigIntegerAccumulator can collect the sum.
+template<typename Iterator, typename T>
+T Accumulate(Iterator begin, Iterator end, T init) {
+  for (Iterator iter{begin}; iter != end; ++iter) {
+    init += *iter;
+  }
+  return init;
 }
 
-template<typename Iterator, typename FunctorType>
-int CountIf(Iterator begin, Iterator end, FunctorType pred) {
-  int accumulator{0};
+template<typename Iterator, typename Predicate>
+typename std::iterator_traits<Iterator>::difference_type
+CountIf(Iterator begin, Iterator end, Predicate pred) {
+  typename std::iterator_traits<Iterator>::difference_type accumulator{0};
   for (Iterator iter{begin}; iter != end; ++iter) {
     accumulator += (pred(*iter) ? 1 : 0);
   }
   return accumulator;
 }
 
-template<typename Iterator>
-int CountIfNot(
-    Iterator begin,
-    Iterator end,
-    bool (*pred)(const typename std::iterator_traits<Iterator>::value_type&)) {
-  int accumulator{0};
+template<typename Iterator, typename Predicate>
+typename std::iterator_traits<Iterator>::difference_type
+CountIfNot(Iterator begin, Iterator end, Predicate pred) {
+  typename std::iterator_traits<Iterator>::difference_type accumulator{0};
   for (Iterator iter{begin}; iter != end; ++iter) {
     accumulator += (pred(*iter) ? 0 : 1);
   }
   return accumulator;
 }
 
-template<typename Iterator>
-Iterator FindIf(
-    Iterator begin,
-    Iterator end,
-    std::function<bool
-        (const typename std::iterator_traits<Iterator>::value_type&)> pred) {
+template<typename Iterator, typename Predicate>
+Iterator FindIf(Iterator begin, Iterator end, Predicate pred) {
   for (Iterator iter{begin}; iter != end; ++iter) {
     if (pred(*iter)) {
       return iter;
@@ -83,4 +131,368 @@ Iterator FindIf(
   return end;
 }
 
+namespace execution::internal {
+
+// Shorter chunks are not worth a task.
+inline constexpr size_t kParallelGrain = 1 << 14;
+// A parallel search checks for a match before it looks at the chunks
+// behind it once per block of this length.
+inline constexpr size_t kCancellationBlock = 1 << 12;
+// Lanes of the vectorized kernels, enough for a few AVX registers, and the
+// values they look at between two branches.
+inline constexpr size_t kLanes = 16;
+inline constexpr size_t kBlock = 16 * kLanes;
+
+template<typename Iterator>
+concept ContiguousArithmetic =
+    std::contiguous_iterator<Iterator> &&
+    std::is_arithmetic_v<std::iter_value_t<Iterator>>;
+
+template<typename Policy, typename Iterator>
+concept Parallel = std::same_as<std::remove_cvref_t<Policy>, ParallelPolicy> &&
+                   std::random_access_iterator<Iterator>;
+template<typename Policy, typename Iterator>
+concept Vectorized =
+    std::same_as<std::remove_cvref_t<Policy>, VectorizedPolicy> &&
+    ContiguousArithmetic<Iterator>;
+
+template<typename T>
+T VectorizedSum(const T* data, size_t size) {
+  T lanes[kLanes]{};
+  size_t i{0};
+  for (; i + kLanes <= size; i += kLanes) {
+    for (size_t lane{0}; lane < kLanes; ++lane) {
+      lanes[lane] += data[i + lane];
+    }
+  }
+  T sum{};
+  for (size_t lane{0}; lane < kLanes; ++lane) {
+    sum += lanes[lane];
+  }
+  for (; i < size; ++i) {
+    sum += data[i];
+  }
+  return sum;
+}
+// The first of the largest values, which must not be NaN. Only the block
+// where the maximum last grew is searched for it again.
+template<typename T>
+const T* VectorizedMax(const T* data, size_t size) {
+  if (size == 0) {
+    return data;
+  }
+  T max{data[0]};
+  size_t block{0};
+  size_t i{0};
+  for (; i + kBlock <= size; i += kBlock) {
+    T lanes[kLanes];
+    std::copy(data + i, data + i + kLanes, lanes);
+    for (size_t j{kLanes}; j < kBlock; j += kLanes) {
+      for (size_t lane{0}; lane < kLanes; ++lane) {
+        lanes[lane] = lanes[lane] < data[i + j + lane] ? data[i + j + lane]
+                                                       : lanes[lane];
+      }
+    }
+    T block_max{*std::max_element(lanes, lanes + kLanes)};
+    if (max < block_max) {
+      max = block_max;
+      block = i;
+    }
+  }
+  const T* result{
+      std::find(data + block, data + std::min(i, block + kBlock), max)};
+  for (; i < size; ++i) {
+    if (max < data[i]) {
+      max = data[i];
+      result = data + i;
+    }
+  }
+  return result;
+}
+template<typename T, typename Predicate>
+ptrdiff_t VectorizedCount(const T* data, size_t size, Predicate& pred) {
+  ptrdiff_t count{0};
+  for (size_t i{0}; i < size; ++i) {
+    count += static_cast<bool>(pred(data[i]));
+  }
+  return count;
+}
+// The matches are collected as integers, since the compiler does not
+// vectorize a reduction of bools.
+template<typename T, typename Predicate>
+const T* VectorizedFind(const T* data, size_t size, Predicate& pred) {
+  size_t i{0};
+  for (; i + kBlock <= size; i += kBlock) {
+    unsigned matches{0};
+    for (size_t j{0}; j < kBlock; ++j) {
+      matches |= static_cast<unsigned>(static_cast<bool>(pred(data[i + j])));
+    }
+    if (matches != 0) {
+      break;
+    }
+  }
+  for (; i < size; ++i) {
+    if (pred(data[i])) {
+      return data + i;
+    }
+  }
+  return data + size;
+}
+template<typename T>
+bool VectorizedIsSorted(const T* data, size_t size) {
+  size_t i{0};
+  for (; i + kBlock < size; i += kBlock) {
+    unsigned inversions{0};
+    for (size_t j{0}; j < kBlock; ++j) {
+      inversions |= static_cast<unsigned>(data[i + j + 1] < data[i + j]);
+    }
+    if (inversions != 0) {
+      return false;
+    }
+  }
+  for (; i + 1 < size; ++i) {
+    if (data[i + 1] < data[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The kernels for a single thread, vectorized where possible.
+template<typename Iterator>
+auto SumOf(Iterator first, Iterator last) {
+  if constexpr (ContiguousArithmetic<Iterator>) {
+    return VectorizedSum(std::to_address(first), last - first);
+  } else {
+    return Accumulate(first, last);
+  }
+}
+template<typename Iterator>
+Iterator MaxOf(Iterator first, Iterator last) {
+  if constexpr (ContiguousArithmetic<Iterator>) {
+    auto data{std::to_address(first)};
+    return first + (VectorizedMax(data, last - first) - data);
+  } else {
+    return MaxElement(first, last);
+  }
+}
+template<typename Iterator, typename Predicate>
+auto CountOf(Iterator first, Iterator last, Predicate& pred) {
+  if constexpr (ContiguousArithmetic<Iterator>) {
+    return VectorizedCount(std::to_address(first), last - first, pred);
+  } else {
+    return CountIf(first, last, std::ref(pred));
+  }
+}
+template<typename Iterator, typename Predicate>
+Iterator FindOf(Iterator first, Iterator last, Predicate& pred) {
+  if constexpr (ContiguousArithmetic<Iterator>) {
+    auto data{std::to_address(first)};
+    return first + (VectorizedFind(data, last - first, pred) - data);
+  } else {
+    return FindIf(first, last, std::ref(pred));
+  }
+}
+template<typename Iterator>
+bool IsSortedOf(Iterator first, Iterator last) {
+  if constexpr (ContiguousArithmetic<Iterator>) {
+    return VectorizedIsSorted(std::to_address(first), last - first);
+  } else {
+    return IsSorted(first, last);
+  }
+}
+
+// A few chunks per thread of the default pool, at least kParallelGrain
+// long, or one for a short range.
+inline size_t ChunkCount(size_t size) {
+  return std::max<size_t>(
+      1, std::min(4 * concurrency::ThreadPool::Default().ThreadCount(),
+                  size / kParallelGrain));
+}
+// Calls function(chunk, first, last) for every chunk of [begin, end),
+// possibly in parallel.
+template<typename Iterator, typename Function>
+void ForEachChunk(Iterator begin, Iterator end, size_t chunks,
+                  Function&& function) {
+  size_t size(end - begin);
+  concurrency::ThreadPool::Default().ParallelFor(
+      0, chunks, 1, [&](size_t first, size_t last) {
+        for (size_t chunk{first}; chunk < last; ++chunk) {
+          function(chunk, begin + size * chunk / chunks,
+                   begin + size * (chunk + 1) / chunks);
+        }
+      });
+}
+// The totals of the chunks, in the order of the chunks.
+template<typename Iterator>
+auto ChunkSums(Iterator begin, Iterator end) {
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  size_t chunks{ChunkCount(end - begin)};
+  std::vector<Value> sums(chunks);
+  ForEachChunk(begin, end, chunks,
+               [&sums](size_t chunk, Iterator first, Iterator last) {
+                 sums[chunk] = SumOf(first, last);
+               });
+  return sums;
+}
+// Stores the smallest index that any thread has found yet.
+inline void StoreMin(std::atomic<size_t>& found, size_t index) {
+  size_t current{found.load(std::memory_order_relaxed)};
+  while (index < current &&
+         !found.compare_exchange_weak(current, index,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace execution::internal
+
+template<execution::ExecutionPolicy Policy, typename Iterator>
+bool IsSorted(Policy&&, Iterator begin, Iterator end) {
+  using namespace execution::internal;
+  if constexpr (Parallel<Policy, Iterator>) {
+    std::atomic<bool> is_unsorted{false};
+    // Every chunk also compares its last value with the next one.
+    ForEachChunk(
+        begin, end, ChunkCount(end - begin),
+        [&](size_t, Iterator first, Iterator last) {
+          while (first != last &&
+                 !is_unsorted.load(std::memory_order_relaxed)) {
+            Iterator block_end{
+                first + std::min<size_t>(kCancellationBlock, last - first)};
+            if (!IsSortedOf(first, block_end == end ? end : block_end + 1)) {
+              is_unsorted.store(true, std::memory_order_relaxed);
+            }
+            first = block_end;
+          }
+        });
+    return !is_unsorted.load(std::memory_order_relaxed);
+  } else if constexpr (Vectorized<Policy, Iterator>) {
+    return IsSortedOf(begin, end);
+  } else {
+    return IsSorted(begin, end);
+  }
+}
+
+// The parallel policy keeps the first of the largest values, the
+// vectorized one requires that there is no NaN.
+template<execution::ExecutionPolicy Policy, typename Iterator>
+Iterator MaxElement(Policy&&, Iterator begin, Iterator end) {
+  using namespace execution::internal;
+  if constexpr (Parallel<Policy, Iterator>) {
+    size_t chunks{ChunkCount(end - begin)};
+    std::vector<Iterator> maxima(chunks, end);
+    ForEachChunk(begin, end, chunks,
+                 [&maxima](size_t chunk, Iterator first, Iterator last) {
+                   maxima[chunk] = MaxOf(first, last);
+                 });
+    Iterator candidate{maxima[0]};
+    for (size_t chunk{1}; chunk < chunks; ++chunk) {
+      if (*candidate < *maxima[chunk]) {
+        candidate = maxima[chunk];
+      }
+    }
+    return candidate;
+  } else if constexpr (Vectorized<Policy, Iterator>) {
+    return MaxOf(begin, end);
+  } else {
+    return MaxElement(begin, end);
+  }
+}
+
+// The parallel policy sums every chunk on its own and adds the sums in
+// order.
+template<execution::ExecutionPolicy Policy, typename Iterator>
+typename std::iterator_traits<Iterator>::value_type
+Accumulate(Policy&&, Iterator begin, Iterator end) {
+  using namespace execution::internal;
+  using Value = typename std::iterator_traits<Iterator>::value_type;
+  if constexpr (Parallel<Policy, Iterator>) {
+    std::vector<Value> sums{ChunkSums(begin, end)};
+    if (sums.size() == 1) {
+      return std::move(sums[0]);
+    }
+    return Accumulate(sums.begin(), sums.end());
+  } else if constexpr (Vectorized<Policy, Iterator>) {
+    return SumOf(begin, end);
+  } else {
+    return Accumulate(begin, end);
+  }
+}
+template<execution::ExecutionPolicy Policy, typename Iterator, typename T>
+T Accumulate(Policy&&, Iterator begin, Iterator end, T init) {
+  using namespace execution::internal;
+  if constexpr (Parallel<Policy, Iterator>) {
+    for (auto& sum : ChunkSums(begin, end)) {
+      init += std::move(sum);
+    }
+    return init;
+  } else if constexpr (Vectorized<Policy, Iterator>) {
+    init += SumOf(begin, end);
+    return init;
+  } else {
+    return Accumulate(begin, end, std::move(init));
+  }
+}
+
+template<execution::ExecutionPolicy Policy, typename Iterator,
+         typename Predicate>
+typename std::iterator_traits<Iterator>::difference_type
+CountIf(Policy&&, Iterator begin, Iterator end, Predicate pred) {
+  using namespace execution::internal;
+  if constexpr (Parallel<Policy, Iterator>) {
+    size_t chunks{ChunkCount(end - begin)};
+    std::vector<typename std::iterator_traits<Iterator>::difference_type>
+        counts(chunks);
+    ForEachChunk(begin, end, chunks,
+                 [&](size_t chunk, Iterator first, Iterator last) {
+                   counts[chunk] = CountOf(first, last, pred);
+                 });
+    return Accumulate(counts.begin(), counts.end());
+  } else if constexpr (Vectorized<Policy, Iterator>) {
+    return CountOf(begin, end, pred);
+  } else {
+    return CountIf(begin, end, std::move(pred));
+  }
+}
+template<execution::ExecutionPolicy Policy, typename Iterator,
+         typename Predicate>
+typename std::iterator_traits<Iterator>::difference_type
+CountIfNot(Policy&& policy, Iterator begin, Iterator end, Predicate pred) {
+  return CountIf(std::forward<Policy>(policy), begin, end,
+                 [&pred](const auto& value) { return !pred(value); });
+}
+
+// With the parallel policy, a chunk stops once a match is found in front
+// of it, and pred must be safe to call from several threads.
+template<execution::ExecutionPolicy Policy, typename Iterator,
+         typename Predicate>
+Iterator FindIf(Policy&&, Iterator begin, Iterator end, Predicate pred) {
+  using namespace execution::internal;
+  if constexpr (Parallel<Policy, Iterator>) {
+    size_t size(end - begin);
+    std::atomic<size_t> found{size};
+    ForEachChunk(
+        begin, end, ChunkCount(size),
+        [&](size_t, Iterator first, Iterator last) {
+          while (first != last &&
+                 found.load(std::memory_order_relaxed) >
+                     static_cast<size_t>(first - begin)) {
+            Iterator block_end{
+                first + std::min<size_t>(kCancellationBlock, last - first)};
+            Iterator match{FindOf(first, block_end, pred)};
+            if (match != block_end) {
+              StoreMin(found, match - begin);
+              return;
+            }
+            first = block_end;
+          }
+        });
+    return begin + found.load(std::memory_order_relaxed);
+  } else if constexpr (Vectorized<Policy, Iterator>) {
+    return FindOf(begin, end, pred);
+  } else {
+    return FindIf(begin, end, std::move(pred));
+  }
+}
+
 #endif  // ALGORITHMS_H_
@@ -0,0 +1,121 @@
+#ifndef ATOMIC_SHARED_PTR_H_
+#define ATOMIC_SHARED_PTR_H_
+
+#include <atomic>
+#include <utility>
+
+#include "epoch_reclamation.h"
+#include "shared_ptr.h"
+
+namespace pointers {
+
+// A SharedPtr that threads may load and replace at once, for publishing
+// read-mostly objects. Loads never lock or wait: the reader pins the
+// default EpochDomain, reads the current binding and counts a new use. A
+// replaced binding keeps its use until it is reclaimed through the
+// domain, so the count a pinned reader increments never drops to zero
+// under it. Every store allocates a binding, which suits data that is
+// read far more often than it is replaced.
+//
+// A replacement unpins the writer and then collects through the domain,
+// so the replaced binding drops its use before the call returns unless a
+// thread was pinned meanwhile, such as a reader inside Load or a writer
+// holding a Guard of its own. Such a binding waits for the next
+// replacement or retirement by the same thread that finds no thread
+// pinned, and if the thread exits first, for one by any other thread.
+template<typename T>
+class AtomicSharedPtr {
+ public:
+  using Pointer = SharedPtr<T, AtomicPolicy>;
+
+  AtomicSharedPtr() = default;
+  explicit AtomicSharedPtr(Pointer desired)
+      : binding_(NewBinding(std::move(desired))) {}
+  AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+  AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+  // Requires that no other thread uses the pointer anymore.
+  ~AtomicSharedPtr() {
+    delete this->binding_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] Pointer Load() const {
+    concurrency::EpochDomain::Guard guard;
+    Binding* binding{this->binding_.load(std::memory_order_acquire)};
+    return binding ? binding->value : Pointer();
+  }
+  void Store(Pointer desired) {
+    this->Exchange(std::move(desired));
+  }
+  // Returns the pointer that was stored before.
+  Pointer Exchange(Pointer desired) {
+    Binding* binding{NewBinding(std::move(desired))};
+    Pointer result;
+    {
+      concurrency::EpochDomain::Guard guard;
+      Binding* previous{this->binding_.exchange(binding,
+                                                std::memory_order_acq_rel)};
+      if (previous == nullptr) {
+        return result;
+      }
+      result = previous->value;
+      Retire(previous);
+    }
+    concurrency::EpochDomain::Default().TryCollect();
+    return result;
+  }
+  // Stores desired if the current pointer points to the same object as
+  // expected, otherwise loads the current pointer into expected.
+  bool CompareExchange(Pointer& expected, Pointer desired);
+
+ private:
+  struct Binding {
+    Pointer value;
+  };
+
+  static Binding* NewBinding(Pointer&& value) {
+    return value.Get() ? new Binding{std::move(value)} : nullptr;
+  }
+  static void DeleteBinding(void* binding) {
+    delete static_cast<Binding*>(binding);
+  }
+  static void Retire(Binding* binding) {
+    concurrency::EpochDomain::Default().Retire(binding, &DeleteBinding);
+  }
+
+  std::atomic<Binding*> binding_{nullptr};
+};
+template<typename T>
+bool AtomicSharedPtr<T>::CompareExchange(Pointer& expected, Pointer desired) {
+  {
+    concurrency::EpochDomain::Guard guard;
+    Binding* current{this->binding_.load(std::memory_order_acquire)};
+    Binding* binding{nullptr};
+    bool is_exchanged{false};
+    // The binding that was read cannot be reclaimed and reused while the
+    // thread is pinned, so comparing addresses is free of ABA.
+    while (!is_exchanged &&
+           (current ? current->value.Get() : nullptr) == expected.Get()) {
+      if (binding == nullptr && desired.Get()) {
+        binding = NewBinding(std::move(desired));
+      }
+      is_exchanged = this->binding_.compare_exchange_weak(
+          current, binding, std::memory_order_acq_rel,
+          std::memory_order_acquire);
+    }
+    if (!is_exchanged) {
+      delete binding;
+      expected = current ? current->value : Pointer();
+      return false;
+    }
+    if (current == nullptr) {
+      return true;
+    }
+    Retire(current);
+  }
+  concurrency::EpochDomain::Default().TryCollect();
+  return true;
+}
+
+}  // namespace pointers
+
+#endif  // ATOMIC_SHARED_PTR_H_
@@ -0,0 +1,655 @@
+#ifndef B_PLUS_TREE_H_
+#define B_PLUS_TREE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "node_pool.h"
+
+// Sorted multiset with the interface of BinarySearchTree, kept in a B+ tree.
+// Every node holds about kNodeBytes of keys, so a lookup touches a few cache
+// lines per level instead of one node per comparison, and the leaves are
+// linked in order, so iteration reads them one after another. Equal values
+// are kept in insertion order.
+//
+// T has to be default constructible and move assignable. Inserting or
+// erasing a value invalidates the iterators into the leaves it changes.
+template<typename T, typename Allocator = std::allocator<T>>
+class BPlusTree {
+ public:
+  static constexpr size_t kNodeBytes = 256;
+  static constexpr int kLeafCapacity =
+      std::max(8, static_cast<int>(kNodeBytes / sizeof(T)));
+  static constexpr int kInnerCapacity =
+      std::max(8, static_cast<int>(kNodeBytes / (sizeof(T) + sizeof(void*))));
+
+ private:
+  using AllocatorTraits = std::allocator_traits<Allocator>;
+
+  // Nodes other than the root are refilled or merged below half capacity.
+  static constexpr int kMinLeafSize = kLeafCapacity / 2;
+  static constexpr int kMinInnerSize = kInnerCapacity / 2;
+
+  struct InnerNode;
+  struct Node {
+    explicit Node(bool is_leaf) : is_leaf(is_leaf) {}
+
+    InnerNode* parent{nullptr};
+    // The number of values of a leaf or keys of an inner node.
+    int size{0};
+    bool is_leaf;
+  };
+  struct LeafNode : Node {
+    LeafNode() : Node(true) {}
+
+    LeafNode* prev{nullptr};
+    LeafNode* next{nullptr};
+    T values[kLeafCapacity];
+  };
+  struct InnerNode : Node {
+    InnerNode() : Node(false) {}
+
+    // The values under children[i] are not greater than keys[i], and those
+    // under children[i + 1] are not less.
+    T keys[kInnerCapacity];
+    Node* children[kInnerCapacity + 1];
+  };
+
+ public:
+  class ConstIterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    reference operator*() const { return leaf_->values[index_]; }
+    pointer operator->() const { return &leaf_->values[index_]; }
+    ConstIterator& operator++();
+    ConstIterator operator++(int);
+    ConstIterator& operator--();
+    ConstIterator operator--(int);
+
+    bool operator==(ConstIterator rhs) const {
+      return leaf_ == rhs.leaf_ && index_ == rhs.index_;
+    }
+    bool operator!=(ConstIterator rhs) const { return !(*this == rhs); }
+
+   private:
+    explicit ConstIterator(LeafNode* leaf, int index, const BPlusTree* parent)
+        : leaf_(leaf), index_(index), parent_(parent) {}
+
+    friend class BPlusTree;
+
+    LeafNode* leaf_;
+    int index_;
+    const BPlusTree* parent_;
+  };
+
+  using allocator_type = Allocator;
+
+  BPlusTree() = default;
+  explicit BPlusTree(const Allocator& allocator)
+      : leaf_pool_(allocator), inner_pool_(allocator) {}
+  BPlusTree(std::initializer_list<T>, const Allocator& allocator = Allocator());
+  // The copy is built bottom-up with full leaves laid out in sorted order.
+  BPlusTree(const BPlusTree& source)
+      : BPlusTree(AllocatorTraits::select_on_container_copy_construction(
+            source.get_allocator())) {
+    CopyFrom(source);
+  }
+  BPlusTree(BPlusTree&& source) noexcept
+      : BPlusTree(source.get_allocator()) {
+    MoveFrom(std::move(source));
+  }
+  ~BPlusTree() { ReleaseMemoryAndReset(); }
+  BPlusTree& operator=(const BPlusTree&);
+  // Copies the values when the allocators differ.
+  BPlusTree& operator=(BPlusTree&&) noexcept(
+      AllocatorTraits::is_always_equal::value);
+
+  [[nodiscard]] allocator_type get_allocator() const {
+    return leaf_pool_.get_allocator();
+  }
+
+  [[nodiscard]] int size() const { return size_; }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  [[nodiscard]] bool contains(const T& value) const {
+    return find(value) != end();
+  }
+  [[nodiscard]] int count(const T&) const;
+  [[nodiscard]] std::vector<T> to_vector() const;
+  void clear() { ReleaseMemoryAndReset(); }
+
+  [[nodiscard]] ConstIterator begin() const {
+    return ConstIterator(first_leaf_, 0, this);
+  }
+  [[nodiscard]] ConstIterator end() const {
+    return ConstIterator(nullptr, 0, this);
+  }
+  // The first of the equal values, if any.
+  [[nodiscard]] ConstIterator find(const T&) const;
+
+  template<typename U>
+  void insert(U&& value) { InsertValue(T(std::forward<U>(value))); }
+  template<typename... Ts>
+  void emplace(Ts&&... args) { InsertValue(T(std::forward<Ts>(args)...)); }
+  void erase(const T& value) { erase(find(value)); }
+  void erase(ConstIterator);
+
+  bool operator==(const BPlusTree&) const;
+  bool operator!=(const BPlusTree& rhs) const { return !(*this == rhs); }
+
+ private:
+  // The number of the first size keys that are less than the value, or with
+  // kOrEqual, not greater than it.
+  template<bool kOrEqual>
+  static int Rank(const T* keys, int size, const T& value);
+  // The leaf that holds the lower bound of the value, or with kOrEqual its
+  // upper bound, unless that is the first value of the next leaf.
+  template<bool kOrEqual>
+  [[nodiscard]] LeafNode* Descend(const T& value) const;
+  [[nodiscard]] static const T& LowestValue(const Node*);
+  [[nodiscard]] static int ChildSlot(const InnerNode* parent,
+                                     const Node* child);
+
+  void InsertValue(T&& value);
+  // Moves the upper half of a full leaf into a new right neighbour.
+  LeafNode* SplitLeaf(LeafNode*);
+  void InsertIntoParent(Node* left, const T& key, Node* right);
+  // Puts the key at keys[slot] and the child right of it.
+  static void InsertKey(InnerNode*, int slot, const T& key, Node* child);
+  void RebalanceLeaf(LeafNode*);
+  void RebalanceInner(InnerNode*);
+  // Moves the contents of right into left and drops the key between them.
+  void MergeLeaves(LeafNode* left, LeafNode* right, int key_slot);
+  void MergeInner(InnerNode* left, InnerNode* right, int key_slot);
+  // Drops keys[slot] and the child right of it.
+  void RemoveKey(InnerNode*, int slot);
+
+  void ReleaseMemoryAndReset();
+  void DestroySubtree(Node*);
+  void CopyFrom(const BPlusTree&);
+  // Requires both trees to have equal allocators.
+  void MoveFrom(BPlusTree&&);
+  void CopyFieldsFrom(const BPlusTree&);
+
+  containers::NodePool<LeafNode, Allocator> leaf_pool_;
+  containers::NodePool<InnerNode, Allocator> inner_pool_;
+  int size_{0};
+  Node* root_{nullptr};
+  LeafNode* first_leaf_{nullptr};
+  LeafNode* last_leaf_{nullptr};
+};
+template<typename T, typename Allocator>
+typename BPlusTree<T, Allocator>::ConstIterator&
+BPlusTree<T, Allocator>::ConstIterator::operator++() {
+  if (++index_ == leaf_->size) {
+    leaf_ = leaf_->next;
+    index_ = 0;
+  }
+  return *this;
+}
+template<typename T, typename Allocator>
+typename BPlusTree<T, Allocator>::ConstIterator
+BPlusTree<T, Allocator>::ConstIterator::operator++(int) {
+  auto copy{*this};
+  ++*this;
+  return copy;
+}
+template<typename T, typename Allocator>
+typename BPlusTree<T, Allocator>::ConstIterator&
+BPlusTree<T, Allocator>::ConstIterator::operator--() {
+  if (!leaf_ || index_ == 0) {
+    leaf_ = leaf_ ? leaf_->prev : parent_->last_leaf_;
+    index_ = leaf_->size;
+  }
+  --index_;
+  return *this;
+}
+template<typename T, typename Allocator>
+typename BPlusTree<T, Allocator>::ConstIterator
+BPlusTree<T, Allocator>::ConstIterator::operator--(int) {
+  auto copy{*this};
+  --*this;
+  return copy;
+}
+template<typename T, typename Allocator>
+BPlusTree<T, Allocator>::BPlusTree(std::initializer_list<T> list,
+                                   const Allocator& allocator)
+    : BPlusTree(allocator) {
+  for (const T& value : list) {
+    insert(value);
+  }
+}
+template<typename T, typename Allocator>
+BPlusTree<T, Allocator>& BPlusTree<T, Allocator>::operator=(
+    const BPlusTree& rhs) {
+  if (this == &rhs) {
+    return *this;
+  }
+  ReleaseMemoryAndReset();
+  CopyFrom(rhs);
+  return *this;
+}
+template<typename T, typename Allocator>
+BPlusTree<T, Allocator>& BPlusTree<T, Allocator>::operator=(
+    BPlusTree&& rhs) noexcept(AllocatorTraits::is_always_equal::value) {
+  if (this == &rhs) {
+    return *this;
+  }
+  ReleaseMemoryAndReset();
+  if (get_allocator() == rhs.get_allocator()) {
+    MoveFrom(std::move(rhs));
+  } else {
+    CopyFrom(rhs);
+  }
+  return *this;
+}
+template<typename T, typename Allocator>
+int BPlusTree<T, Allocator>::count(const T& value) const {
+  int accumulator{0};
+  for (ConstIterator iter{find(value)}; iter != end() && *iter == value;
+       ++iter) {
+    ++accumulator;
+  }
+  return accumulator;
+}
+template<typename T, typename Allocator>
+std::vector<T> BPlusTree<T, Allocator>::to_vector() const {
+  std::vector<T> result;
+  result.reserve(size_);
+  for (const LeafNode* leaf{first_leaf_}; leaf; leaf = leaf->next) {
+    result.insert(result.end(), leaf->values, leaf->values + leaf->size);
+  }
+  return result;
+}
+template<typename T, typename Allocator>
+typename BPlusTree<T, Allocator>::ConstIterator
+BPlusTree<T, Allocator>::find(const T& value) const {
+  if (!root_) {
+    return end();
+  }
+  LeafNode* leaf{Descend<false>(value)};
+  int index{Rank<false>(leaf->values, leaf->size, value)};
+  if (index == leaf->size) {
+    leaf = leaf->next;
+    index = 0;
+  }
+  if (leaf && leaf->values[index] == value) {
+    return ConstIterator(leaf, index, this);
+  }
+  return end();
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::erase(ConstIterator iter) {
+  if (iter == end()) {
+    return;
+  }
+  --size_;
+  LeafNode* leaf{iter.leaf_};
+  std::move(leaf->values + iter.index_ + 1, leaf->values + leaf->size,
+            leaf->values + iter.index_);
+  leaf->values[--leaf->size] = T();
+  if (leaf == root_) {
+    if (leaf->size == 0) {
+      ReleaseMemoryAndReset();
+    }
+  } else if (leaf->size < kMinLeafSize) {
+    RebalanceLeaf(leaf);
+  }
+}
+template<typename T, typename Allocator>
+bool BPlusTree<T, Allocator>::operator==(const BPlusTree& rhs) const {
+  return size() == rhs.size() && std::equal(begin(), end(), rhs.begin());
+}
+template<typename T, typename Allocator>
+template<bool kOrEqual>
+int BPlusTree<T, Allocator>::Rank(const T* keys, int size, const T& value) {
+  if constexpr (std::is_arithmetic_v<T>) {
+    // Counting without branches lets the compiler compare whole vectors of
+    // keys at once, which beats a binary search at these node sizes.
+    int rank{0};
+    for (int i{0}; i < size; ++i) {
+      rank += static_cast<int>(kOrEqual ? !(value < keys[i])
+                                        : keys[i] < value);
+    }
+    return rank;
+  } else if constexpr (kOrEqual) {
+    return static_cast<int>(std::upper_bound(keys, keys + size, value) - keys);
+  } else {
+    return static_cast<int>(std::lower_bound(keys, keys + size, value) - keys);
+  }
+}
+template<typename T, typename Allocator>
+template<bool kOrEqual>
+typename BPlusTree<T, Allocator>::LeafNode*
+BPlusTree<T, Allocator>::Descend(const T& value) const {
+  Node* node{root_};
+  while (!node->is_leaf) {
+    auto* inner{static_cast<InnerNode*>(node)};
+    node = inner->children[Rank<kOrEqual>(inner->keys, inner->size, value)];
+  }
+  return static_cast<LeafNode*>(node);
+}
+template<typename T, typename Allocator>
+const T& BPlusTree<T, Allocator>::LowestValue(const Node* node) {
+  while (!node->is_leaf) {
+    node = static_cast<const InnerNode*>(node)->children[0];
+  }
+  return static_cast<const LeafNode*>(node)->values[0];
+}
+template<typename T, typename Allocator>
+int BPlusTree<T, Allocator>::ChildSlot(const InnerNode* parent,
+                                       const Node* child) {
+  return static_cast<int>(
+      std::find(parent->children, parent->children + parent->size + 1,
+                child) -
+      parent->children);
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::InsertValue(T&& value) {
+  if (!root_) {
+    LeafNode* leaf{leaf_pool_.New()};
+    root_ = leaf;
+    first_leaf_ = leaf;
+    last_leaf_ = leaf;
+  }
+  LeafNode* leaf{Descend<true>(value)};
+  int index{Rank<true>(leaf->values, leaf->size, value)};
+  if (leaf->size == kLeafCapacity) {
+    LeafNode* right{SplitLeaf(leaf)};
+    if (index > leaf->size) {
+      index -= leaf->size;
+      leaf = right;
+    }
+  }
+  std::move_backward(leaf->values + index, leaf->values + leaf->size,
+                     leaf->values + leaf->size + 1);
+  leaf->values[index] = std::move(value);
+  ++leaf->size;
+  ++size_;
+}
+template<typename T, typename Allocator>
+typename BPlusTree<T, Allocator>::LeafNode*
+BPlusTree<T, Allocator>::SplitLeaf(LeafNode* leaf) {
+  LeafNode* right{leaf_pool_.New()};
+  int half{leaf->size / 2};
+  std::move(leaf->values + half, leaf->values + leaf->size, right->values);
+  right->size = leaf->size - half;
+  leaf->size = half;
+  right->prev = leaf;
+  right->next = leaf->next;
+  if (leaf->next) {
+    leaf->next->prev = right;
+  } else {
+    last_leaf_ = right;
+  }
+  leaf->next = right;
+  InsertIntoParent(leaf, right->values[0], right);
+  return right;
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::InsertIntoParent(Node* left, const T& key,
+                                               Node* right) {
+  InnerNode* parent{left->parent};
+  if (!parent) {
+    InnerNode* root{inner_pool_.New()};
+    root->children[0] = left;
+    left->parent = root;
+    InsertKey(root, 0, key, right);
+    root_ = root;
+    return;
+  }
+  int slot{ChildSlot(parent, left)};
+  if (parent->size < kInnerCapacity) {
+    InsertKey(parent, slot, key, right);
+    return;
+  }
+  // The middle key moves up, the keys and children right of it move into
+  // a new sibling.
+  int middle{parent->size / 2};
+  InnerNode* sibling{inner_pool_.New()};
+  std::move(parent->keys + middle + 1, parent->keys + parent->size,
+            sibling->keys);
+  std::copy(parent->children + middle + 1,
+            parent->children + parent->size + 1, sibling->children);
+  sibling->size = parent->size - middle - 1;
+  for (int i{0}; i <= sibling->size; ++i) {
+    sibling->children[i]->parent = sibling;
+  }
+  T separator{std::move(parent->keys[middle])};
+  parent->size = middle;
+  if (slot > middle) {
+    InsertKey(sibling, slot - middle - 1, key, right);
+  } else {
+    InsertKey(parent, slot, key, right);
+  }
+  InsertIntoParent(parent, separator, sibling);
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::InsertKey(InnerNode* node, int slot,
+                                        const T& key, Node* child) {
+  std::move_backward(node->keys + slot, node->keys + node->size,
+                     node->keys + node->size + 1);
+  std::copy_backward(node->children + slot + 1,
+                     node->children + node->size + 1,
+                     node->children + node->size + 2);
+  node->keys[slot] = key;
+  node->children[slot + 1] = child;
+  child->parent = node;
+  ++node->size;
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::RebalanceLeaf(LeafNode* leaf) {
+  InnerNode* parent{leaf->parent};
+  int slot{ChildSlot(parent, leaf)};
+  if (slot > 0) {
+    auto* left{static_cast<LeafNode*>(parent->children[slot - 1])};
+    if (left->size <= kMinLeafSize) {
+      MergeLeaves(left, leaf, slot - 1);
+      return;
+    }
+    std::move_backward(leaf->values, leaf->values + leaf->size,
+                       leaf->values + leaf->size + 1);
+    leaf->values[0] = std::move(left->values[left->size - 1]);
+    left->values[--left->size] = T();
+    ++leaf->size;
+    parent->keys[slot - 1] = leaf->values[0];
+    return;
+  }
+  auto* right{static_cast<LeafNode*>(parent->children[1])};
+  if (right->size <= kMinLeafSize) {
+    MergeLeaves(leaf, right, 0);
+    return;
+  }
+  leaf->values[leaf->size++] = std::move(right->values[0]);
+  std::move(right->values + 1, right->values + right->size, right->values);
+  right->values[--right->size] = T();
+  parent->keys[0] = right->values[0];
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::RebalanceInner(InnerNode* node) {
+  InnerNode* parent{node->parent};
+  int slot{ChildSlot(parent, node)};
+  if (slot > 0) {
+    auto* left{static_cast<InnerNode*>(parent->children[slot - 1])};
+    if (left->size <= kMinInnerSize) {
+      MergeInner(left, node, slot - 1);
+      return;
+    }
+    std::move_backward(node->keys, node->keys + node->size,
+                       node->keys + node->size + 1);
+    std::copy_backward(node->children, node->children + node->size + 1,
+                       node->children + node->size + 2);
+    node->keys[0] = std::move(parent->keys[slot - 1]);
+    node->children[0] = left->children[left->size];
+    node->children[0]->parent = node;
+    ++node->size;
+    parent->keys[slot - 1] = std::move(left->keys[left->size - 1]);
+    left->keys[--left->size] = T();
+    return;
+  }
+  auto* right{static_cast<InnerNode*>(parent->children[1])};
+  if (right->size <= kMinInnerSize) {
+    MergeInner(node, right, 0);
+    return;
+  }
+  node->keys[node->size] = std::move(parent->keys[0]);
+  node->children[node->size + 1] = right->children[0];
+  node->children[node->size + 1]->parent = node;
+  ++node->size;
+  parent->keys[0] = std::move(right->keys[0]);
+  std::move(right->keys + 1, right->keys + right->size, right->keys);
+  std::copy(right->children + 1, right->children + right->size + 1,
+            right->children);
+  right->keys[--right->size] = T();
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::MergeLeaves(LeafNode* left, LeafNode* right,
+                                          int key_slot) {
+  std::move(right->values, right->values + right->size,
+            left->values + left->size);
+  left->size += right->size;
+  left->next = right->next;
+  if (right->next) {
+    right->next->prev = left;
+  } else {
+    last_leaf_ = left;
+  }
+  leaf_pool_.Delete(right);
+  RemoveKey(left->parent, key_slot);
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::MergeInner(InnerNode* left, InnerNode* right,
+                                         int key_slot) {
+  InnerNode* parent{left->parent};
+  left->keys[left->size] = std::move(parent->keys[key_slot]);
+  std::move(right->keys, right->keys + right->size,
+            left->keys + left->size + 1);
+  std::copy(right->children, right->children + right->size + 1,
+            left->children + left->size + 1);
+  for (int i{0}; i <= right->size; ++i) {
+    right->children[i]->parent = left;
+  }
+  left->size += right->size + 1;
+  inner_pool_.Delete(right);
+  RemoveKey(parent, key_slot);
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::RemoveKey(InnerNode* node, int slot) {
+  std::move(node->keys + slot + 1, node->keys + node->size,
+            node->keys + slot);
+  std::copy(node->children + slot + 2, node->children + node->size + 1,
+            node->children + slot + 1);
+  node->keys[--node->size] = T();
+  if (node == root_) {
+    if (node->size == 0) {
+      root_ = node->children[0];
+      root_->parent = nullptr;
+      inner_pool_.Delete(node);
+    }
+  } else if (node->size < kMinInnerSize) {
+    RebalanceInner(node);
+  }
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::ReleaseMemoryAndReset() {
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    if (root_) {
+      DestroySubtree(root_);
+    }
+  }
+  leaf_pool_.Release();
+  inner_pool_.Release();
+  size_ = 0;
+  root_ = nullptr;
+  first_leaf_ = nullptr;
+  last_leaf_ = nullptr;
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::DestroySubtree(Node* node) {
+  if (node->is_leaf) {
+    std::destroy_at(static_cast<LeafNode*>(node));
+    return;
+  }
+  auto* inner{static_cast<InnerNode*>(node)};
+  for (int i{0}; i <= inner->size; ++i) {
+    DestroySubtree(inner->children[i]);
+  }
+  std::destroy_at(inner);
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::CopyFrom(const BPlusTree& source) {
+  if (source.empty()) {
+    return;
+  }
+  // Spreading the values evenly over as few leaves as possible keeps every
+  // leaf at least half full, and the same holds for the inner levels.
+  int leaves{(source.size() + kLeafCapacity - 1) / kLeafCapacity};
+  leaf_pool_.Reserve(leaves);
+  std::vector<Node*> level;
+  level.reserve(leaves);
+  ConstIterator iter{source.begin()};
+  for (int i{0}; i < leaves; ++i) {
+    LeafNode* leaf{leaf_pool_.New()};
+    leaf->size = source.size() / leaves + (i < source.size() % leaves);
+    for (int j{0}; j < leaf->size; ++j, ++iter) {
+      leaf->values[j] = *iter;
+    }
+    leaf->prev = last_leaf_;
+    if (last_leaf_) {
+      last_leaf_->next = leaf;
+    } else {
+      first_leaf_ = leaf;
+    }
+    last_leaf_ = leaf;
+    level.push_back(leaf);
+  }
+  while (level.size() > 1) {
+    size_t parents{(level.size() + kInnerCapacity) / (kInnerCapacity + 1)};
+    std::vector<Node*> upper;
+    upper.reserve(parents);
+    size_t next{0};
+    for (size_t i{0}; i < parents; ++i) {
+      InnerNode* inner{inner_pool_.New()};
+      size_t children{level.size() / parents + (i < level.size() % parents)};
+      for (size_t j{0}; j < children; ++j) {
+        Node* child{level[next++]};
+        if (j > 0) {
+          inner->keys[j - 1] = LowestValue(child);
+        }
+        inner->children[j] = child;
+        child->parent = inner;
+      }
+      inner->size = static_cast<int>(children) - 1;
+      upper.push_back(inner);
+    }
+    level = std::move(upper);
+  }
+  root_ = level[0];
+  size_ = source.size();
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::MoveFrom(BPlusTree&& source) {
+  leaf_pool_ = std::move(source.leaf_pool_);
+  inner_pool_ = std::move(source.inner_pool_);
+  CopyFieldsFrom(source);
+  source.CopyFieldsFrom(BPlusTree());
+}
+template<typename T, typename Allocator>
+void BPlusTree<T, Allocator>::CopyFieldsFrom(const BPlusTree& source) {
+  size_ = source.size_;
+  root_ = source.root_;
+  first_leaf_ = source.first_leaf_;
+  last_leaf_ = source.last_leaf_;
+}
+
+#endif  // B_PLUS_TREE_H_
@@ -0,0 +1,401 @@
+// Timings of the hot paths of every component: BigInteger multiplication,
+// division and ToString for 1 to max limbs, BinarySearchTree insert, find
+// and erase for sorted, random and duplicate-heavy keys, BiDirectionalList
+// pushes, pops and traversals, SharedPtr copies and moves and the
+// reductions of algorithms.h under each execution policy.
+//
+//   g++ -std=c++20 -O2 -pthread -I. -o assignments_benchmark
+//       benchmarks/assignments_benchmark.cpp big_integer*.cpp
+//   ./assignments_benchmark [milliseconds per benchmark]
+//       [largest BigInteger in limbs] [JSON output file]
+//
+// With -DASSIGNMENTS_INSTRUMENTATION every benchmark also reports the
+// counters of instrumentation.h per item, with allocations counted by the
+// replacement operator new below.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "algorithms.h"
+#include "bidirectional_list.h"
+#include "big_integer.h"
+#include "binary_search_tree.h"
+#include "instrumentation.h"
+#include "shared_ptr.h"
+#include "thread_pool.h"
+
+#ifdef ASSIGNMENTS_INSTRUMENTATION
+void* operator new(size_t size) {
+  INSTRUMENT_COUNT(kAllocations, 1);
+  INSTRUMENT_COUNT(kAllocatedBytes, size);
+  if (void* memory{std::malloc(size == 0 ? 1 : size)}) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+void* operator new(size_t size, std::align_val_t alignment) {
+  INSTRUMENT_COUNT(kAllocations, 1);
+  INSTRUMENT_COUNT(kAllocatedBytes, size);
+  size_t align{static_cast<size_t>(alignment)};
+  if (void* memory{std::aligned_alloc(align, (size + align - 1) / align *
+                                                 align)}) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+// Out of line, since GCC takes free in an inlined delete to be mismatched
+// with the new expression.
+[[gnu::noinline]] void operator delete(void* memory) noexcept {
+  std::free(memory);
+}
+[[gnu::noinline]] void operator delete(void* memory, size_t) noexcept {
+  std::free(memory);
+}
+[[gnu::noinline]] void operator delete(void* memory,
+                                       std::align_val_t) noexcept {
+  std::free(memory);
+}
+[[gnu::noinline]] void operator delete(void* memory, size_t,
+                                       std::align_val_t) noexcept {
+  std::free(memory);
+}
+#endif
+
+namespace {
+
+using big_num_arithmetic::BigInteger;
+using containers::BiDirectionalList;
+using instrumentation::Snapshot;
+
+// Keeps results from being optimized away.
+volatile int64_t sink;
+
+// Times the parts of a run between Start and Stop, so that setup and
+// cleanup are excluded, and counts their work.
+class Stopwatch {
+ public:
+  void Start() {
+    this->snapshot_ = Snapshot::Take();
+    this->start_ = std::chrono::steady_clock::now();
+  }
+  void Stop() {
+    this->elapsed_ += std::chrono::steady_clock::now() - this->start_;
+    this->counters_ += Snapshot::Take() - this->snapshot_;
+  }
+
+  [[nodiscard]] double Seconds() const { return this->elapsed_.count(); }
+  [[nodiscard]] const Snapshot& Counters() const { return this->counters_; }
+
+ private:
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::duration<double> elapsed_{0};
+  Snapshot snapshot_;
+  Snapshot counters_;
+};
+
+struct Result {
+  std::string name;
+  double items_per_run;
+  int runs;
+  double nanoseconds_per_item;
+  Snapshot counters;
+};
+
+class Runner {
+ public:
+  explicit Runner(int milliseconds) : seconds_(milliseconds / 1000.0) {}
+
+  // Calls run(stopwatch) until the timed parts add up to the time per
+  // benchmark, at least once. Each run handles items_per_run items.
+  template<typename Function>
+  void Run(const std::string& name, double items_per_run, Function&& run) {
+    Stopwatch stopwatch;
+    int runs{0};
+    do {
+      run(stopwatch);
+      ++runs;
+    } while (stopwatch.Seconds() < this->seconds_);
+    double items{items_per_run * runs};
+    Result result{name, items_per_run, runs,
+                  stopwatch.Seconds() * 1e9 / items, stopwatch.Counters()};
+    std::printf("%-40s %8d runs %14.2f ns/item", name.c_str(), runs,
+                result.nanoseconds_per_item);
+    if constexpr (instrumentation::kIsEnabled) {
+      for (size_t i{0}; i < instrumentation::kCounterCount; ++i) {
+        std::printf("  %s %.2f", instrumentation::kCounterNames[i],
+                    result.counters.values[i] / items);
+      }
+    }
+    std::printf("\n");
+    std::fflush(stdout);
+    this->results_.push_back(std::move(result));
+  }
+
+  void WriteJson(std::FILE* file) const {
+    std::fprintf(file, "[\n");
+    for (size_t i{0}; i < this->results_.size(); ++i) {
+      const Result& result{this->results_[i]};
+      double items{result.items_per_run * result.runs};
+      std::fprintf(file,
+                   "  {\"name\": \"%s\", \"items_per_run\": %.0f, "
+                   "\"runs\": %d, \"ns_per_item\": %.3f",
+                   result.name.c_str(), result.items_per_run, result.runs,
+                   result.nanoseconds_per_item);
+      if constexpr (instrumentation::kIsEnabled) {
+        std::fprintf(file, ", \"counters_per_item\": %s",
+                     result.counters.ToJson(items).c_str());
+      }
+      std::fprintf(file, "}%s\n", i + 1 < this->results_.size() ? "," : "");
+    }
+    std::fprintf(file, "]\n");
+  }
+
+ private:
+  double seconds_;
+  std::vector<Result> results_;
+};
+
+std::mt19937_64 random_engine{42};
+
+BigInteger RandomInteger(size_t limbs) {
+  std::uniform_int_distribution<BigInteger::Limb> limb(
+      0, BigInteger::internal_base - 1);
+  std::vector<BigInteger::Limb> magnitude(limbs);
+  for (BigInteger::Limb& value : magnitude) {
+    value = limb(random_engine);
+  }
+  magnitude.back() = std::max<BigInteger::Limb>(magnitude.back(), 1);
+  return BigInteger::ImportLimbs(magnitude);
+}
+
+void BenchmarkBigInteger(Runner& runner, size_t max_limbs) {
+  for (size_t limbs{1}; limbs <= max_limbs; limbs *= 4) {
+    std::string size{std::to_string(limbs)};
+    BigInteger lhs{RandomInteger(limbs)};
+    BigInteger rhs{RandomInteger(limbs)};
+    BigInteger dividend{RandomInteger(2 * limbs)};
+    runner.Run("big_integer/multiply/" + size, 1, [&](Stopwatch& watch) {
+      watch.Start();
+      BigInteger product{lhs * rhs};
+      watch.Stop();
+      sink = product.Sign();
+    });
+    runner.Run("big_integer/divide/" + size, 1, [&](Stopwatch& watch) {
+      watch.Start();
+      BigInteger quotient{dividend / rhs};
+      watch.Stop();
+      sink = quotient.Sign();
+    });
+    runner.Run("big_integer/to_string/" + size, 1, [&](Stopwatch& watch) {
+      watch.Start();
+      std::string digits{lhs.ToString(10)};
+      watch.Stop();
+      sink = static_cast<int64_t>(digits.size());
+    });
+  }
+}
+
+std::vector<int> Keys(const std::string& distribution, int count) {
+  std::vector<int> keys(count);
+  std::iota(keys.begin(), keys.end(), 0);
+  if (distribution == "duplicates") {
+    for (int& key : keys) {
+      key %= 16;
+    }
+  }
+  if (distribution != "sorted") {
+    std::shuffle(keys.begin(), keys.end(), random_engine);
+  }
+  return keys;
+}
+
+void BenchmarkTree(Runner& runner) {
+  for (int count : {1 << 10, 1 << 16, 1 << 20}) {
+    for (std::string distribution : {"sorted", "random", "duplicates"}) {
+      std::string suffix{"/" + distribution + "/" + std::to_string(count)};
+      std::vector<int> keys{Keys(distribution, count)};
+      std::vector<int> lookups{keys};
+      std::shuffle(lookups.begin(), lookups.end(), random_engine);
+      runner.Run("tree/insert" + suffix, count, [&](Stopwatch& watch) {
+        BinarySearchTree<int> tree;
+        watch.Start();
+        for (int key : keys) {
+          tree.insert(key);
+        }
+        watch.Stop();
+      });
+      BinarySearchTree<int> tree;
+      for (int key : keys) {
+        tree.insert(key);
+      }
+      runner.Run("tree/find" + suffix, count, [&](Stopwatch& watch) {
+        int64_t found{0};
+        watch.Start();
+        for (int key : lookups) {
+          found += tree.find(key) != tree.end();
+        }
+        watch.Stop();
+        sink = found;
+      });
+      runner.Run("tree/erase" + suffix, count, [&](Stopwatch& watch) {
+        BinarySearchTree<int> copy{tree};
+        watch.Start();
+        for (int key : lookups) {
+          copy.erase(key);
+        }
+        watch.Stop();
+      });
+    }
+  }
+}
+
+void BenchmarkList(Runner& runner) {
+  for (int count : {1 << 10, 1 << 20}) {
+    std::string suffix{"/" + std::to_string(count)};
+    runner.Run("list/push_back" + suffix, count, [&](Stopwatch& watch) {
+      BiDirectionalList<int> list;
+      watch.Start();
+      for (int i{0}; i < count; ++i) {
+        list.PushBack(i);
+      }
+      watch.Stop();
+    });
+    runner.Run("list/pop_front" + suffix, count, [&](Stopwatch& watch) {
+      BiDirectionalList<int> list;
+      for (int i{0}; i < count; ++i) {
+        list.PushBack(i);
+      }
+      watch.Start();
+      for (int i{0}; i < count; ++i) {
+        list.PopFront();
+      }
+      watch.Stop();
+    });
+    BiDirectionalList<int> list;
+    for (int i{0}; i < count; ++i) {
+      list.PushBack(i);
+    }
+    runner.Run("list/traverse" + suffix, count, [&](Stopwatch& watch) {
+      int64_t sum{0};
+      watch.Start();
+      for (int value : list) {
+        sum += value;
+      }
+      watch.Stop();
+      sink = sum;
+    });
+    runner.Run("list/find" + suffix, count, [&](Stopwatch& watch) {
+      watch.Start();
+      sink = list.Find(-1);
+      watch.Stop();
+    });
+  }
+}
+
+template<typename Policy>
+void BenchmarkSharedPtr(Runner& runner, const std::string& policy) {
+  constexpr int kCount{1 << 16};
+  std::vector<pointers::SharedPtr<int, Policy>> sources;
+  for (int i{0}; i < kCount; ++i) {
+    sources.push_back(pointers::MakeShared<int, Policy>(i));
+  }
+  runner.Run("shared_ptr/make/" + policy, kCount, [&](Stopwatch& watch) {
+    std::vector<pointers::SharedPtr<int, Policy>> made(kCount);
+    watch.Start();
+    for (int i{0}; i < kCount; ++i) {
+      made[i] = pointers::MakeShared<int, Policy>(i);
+    }
+    watch.Stop();
+  });
+  runner.Run("shared_ptr/copy/" + policy, kCount, [&](Stopwatch& watch) {
+    std::vector<pointers::SharedPtr<int, Policy>> copies(kCount);
+    watch.Start();
+    for (int i{0}; i < kCount; ++i) {
+      copies[i] = sources[i];
+    }
+    watch.Stop();
+  });
+  runner.Run("shared_ptr/move/" + policy, kCount, [&](Stopwatch& watch) {
+    std::vector<pointers::SharedPtr<int, Policy>> moved(kCount);
+    watch.Start();
+    for (int i{0}; i < kCount; ++i) {
+      moved[i] = std::move(sources[i]);
+    }
+    for (int i{0}; i < kCount; ++i) {
+      sources[i] = std::move(moved[i]);
+    }
+    watch.Stop();
+  });
+}
+
+template<typename Policy>
+void BenchmarkAlgorithms(Runner& runner, const std::string& policy_name,
+                         Policy policy) {
+  constexpr int kCount{1 << 22};
+  std::vector<int> values(kCount);
+  std::iota(values.begin(), values.end(), 0);
+  auto is_negative{[](int value) { return value < 0; }};
+  auto run{[&](const std::string& name, auto&& algorithm) {
+    runner.Run("algorithms/" + name + "/" + policy_name, kCount,
+               [&](Stopwatch& watch) {
+                 watch.Start();
+                 sink = static_cast<int64_t>(algorithm());
+                 watch.Stop();
+               });
+  }};
+  run("accumulate", [&] {
+    return Accumulate(policy, values.begin(), values.end(), int64_t{0});
+  });
+  run("max_element", [&] {
+    return *MaxElement(policy, values.begin(), values.end());
+  });
+  run("count_if", [&] {
+    return CountIf(policy, values.begin(), values.end(), is_negative);
+  });
+  run("find_if", [&] {
+    return FindIf(policy, values.begin(), values.end(), is_negative) -
+           values.begin();
+  });
+  run("is_sorted", [&] {
+    return IsSorted(policy, values.begin(), values.end());
+  });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int milliseconds{argc > 1 ? std::atoi(argv[1]) : 200};
+  size_t max_limbs{argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                            : size_t{1} << 20};
+  concurrency::ThreadPool::SetDefaultThreadCount(0);
+  std::printf("%zu threads, instrumentation %s\n",
+              concurrency::ThreadPool::Default().ThreadCount(),
+              instrumentation::kIsEnabled ? "on" : "off");
+  Runner runner(milliseconds);
+  BenchmarkBigInteger(runner, max_limbs);
+  BenchmarkTree(runner);
+  BenchmarkList(runner);
+  BenchmarkSharedPtr<pointers::NonAtomicPolicy>(runner, "non_atomic");
+  BenchmarkSharedPtr<pointers::AtomicPolicy>(runner, "atomic");
+  BenchmarkAlgorithms(runner, "sequential", execution::kSequential);
+  BenchmarkAlgorithms(runner, "parallel", execution::kParallel);
+  BenchmarkAlgorithms(runner, "vectorized", execution::kVectorized);
+  if (argc > 3) {
+    if (std::FILE* file{std::fopen(argv[3], "w")}) {
+      runner.WriteJson(file);
+      std::fclose(file);
+    } else {
+      std::perror(argv[3]);
+      return 1;
+    }
+  }
+}
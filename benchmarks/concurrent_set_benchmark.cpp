@@ -0,0 +1,128 @@
+// Throughput of ConcurrentSkipList against a BinarySearchTree behind one
+// mutex, for 1 to 64 threads running a mix of lookups and updates on a
+// shared set.
+//
+//   g++ -std=c++20 -O2 -pthread -I. benchmarks/concurrent_set_benchmark.cpp
+//   ./a.out [milliseconds per run] [percentage of updates]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "binary_search_tree.h"
+#include "concurrent_skip_list.h"
+
+namespace {
+
+constexpr int kKeyRange = 1 << 20;
+
+class LockedTree {
+ public:
+  bool contains(int value) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->tree_.contains(value);
+  }
+  void insert(int value) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->tree_.insert(value);
+  }
+  void erase(int value) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->tree_.erase(value);
+  }
+
+ private:
+  std::mutex mutex_;
+  BinarySearchTree<int> tree_;
+};
+
+struct Random {
+  uint32_t Next() {
+    this->state ^= this->state << 13;
+    this->state ^= this->state >> 7;
+    this->state ^= this->state << 17;
+    return static_cast<uint32_t>(this->state >> 16);
+  }
+
+  uint64_t state;
+};
+
+// Operations per second over all threads. Half of the updates insert and
+// half erase, so the set keeps its initial size of half the key range.
+template<typename Set>
+double Measure(int thread_count, int milliseconds, uint32_t update_percent) {
+  Set set;
+  Random random{0x9E3779B97F4A7C15u};
+  for (int i{0}; i < kKeyRange / 2; ++i) {
+    set.insert(static_cast<int>(random.Next() % kKeyRange));
+  }
+  std::atomic<bool> is_running{true};
+  std::atomic<int> ready{0};
+  std::vector<uint64_t> operations(thread_count * 8);
+  std::vector<std::thread> threads;
+  for (int i{0}; i < thread_count; ++i) {
+    threads.emplace_back([&, i] {
+      Random random{0x2545F4914F6CDD1Du * (i + 1)};
+      uint64_t done{0};
+      uint64_t found{0};
+      ready.fetch_add(1);
+      while (is_running.load(std::memory_order_relaxed)) {
+        uint32_t choice{random.Next() % 200};
+        int value{static_cast<int>(random.Next() % kKeyRange)};
+        if (choice < update_percent) {
+          set.insert(value);
+        } else if (choice < 2 * update_percent) {
+          set.erase(value);
+        } else {
+          found += set.contains(value);
+        }
+        ++done;
+      }
+      // Spaced out so that the counters do not share cache lines. The hits
+      // are stored only to keep the lookups from being optimized away.
+      operations[i * 8] = done;
+      operations[i * 8 + 1] = found;
+    });
+  }
+  while (ready.load() != thread_count) {
+    std::this_thread::yield();
+  }
+  auto start{std::chrono::steady_clock::now()};
+  std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+  is_running.store(false);
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() -
+                                        start};
+  uint64_t total{0};
+  for (int i{0}; i < thread_count; ++i) {
+    total += operations[i * 8];
+  }
+  return total / elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int milliseconds{argc > 1 ? std::atoi(argv[1]) : 1000};
+  uint32_t update_percent{argc > 2 ? static_cast<uint32_t>(std::atoi(argv[2]))
+                                   : 10};
+  std::printf("%u%% updates, %u hardware threads\n", update_percent,
+              std::thread::hardware_concurrency());
+  std::printf("%8s %18s %18s\n", "threads", "skip list Mop/s",
+              "locked tree Mop/s");
+  for (int threads{1}; threads <= 64; threads *= 2) {
+    double skip_list{Measure<concurrency::ConcurrentSkipList<int>>(
+        threads, milliseconds, update_percent)};
+    double locked_tree{
+        Measure<LockedTree>(threads, milliseconds, update_percent)};
+    std::printf("%8d %18.2f %18.2f\n", threads, skip_list / 1e6,
+                locked_tree / 1e6);
+  }
+}
@@ -4,8 +4,11 @@
 #include <utility>
 #include <vector>
 #include <cassert>
-#include <iostream>
+#include <cstddef>
+#include <functional>
+#include <iterator>
 #include <stack>
+#include <type_traits>
 
 namespace containers {
 
@@ -24,6 +27,65 @@ class BiDirectionalList {
 
     friend class BiDirectionalList<T>;
   };
+
+  template<bool kConst>
+  class BasicIterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<kConst, const T*, T*>;
+    using reference = std::conditional_t<kConst, const T&, T&>;
+
+    BasicIterator() = default;
+    // Iterators may be made const.
+    template<bool kOtherConst>
+      requires(kConst || !kOtherConst)
+    BasicIterator(const BasicIterator<kOtherConst>& source)
+        : node_(source.node_), list_(source.list_) {}
+
+    reference operator*() const {
+      return this->node_->value;
+    }
+    pointer operator->() const {
+      return &this->node_->value;
+    }
+    BasicIterator& operator++() {
+      this->node_ = this->node_->next_;
+      return *this;
+    }
+    BasicIterator operator++(int) {
+      BasicIterator copy{*this};
+      ++*this;
+      return copy;
+    }
+    // The end iterator steps back to the last element.
+    BasicIterator& operator--() {
+      this->node_ = this->node_ ? this->node_->prev_ : this->list_->back_;
+      return *this;
+    }
+    BasicIterator operator--(int) {
+      BasicIterator copy{*this};
+      --*this;
+      return copy;
+    }
+    bool operator==(const BasicIterator& rhs) const {
+      return this->node_ == rhs.node_;
+    }
+
+   private:
+    BasicIterator(Node* node, const BiDirectionalList* list)
+        : node_(node), list_(list) {}
+
+    friend class BiDirectionalList<T>;
+    friend class BasicIterator<!kConst>;
+
+    Node* node_{nullptr};
+    const BiDirectionalList* list_{nullptr};
+  };
+  using Iterator = BasicIterator<false>;
+  using ConstIterator = BasicIterator<true>;
+
   BiDirectionalList() = default;
   BiDirectionalList(std::initializer_list<T> source) {
     for (const T& element : source) {
@@ -69,12 +131,26 @@ class BiDirectionalList {
 
   std::vector<T> ToVector() const {
     std::vector<T> result;
+    result.reserve(this->size_);
     for (Node* iter{this->front_}; iter != nullptr; iter = iter->next_) {
       result.push_back(iter->value);
     }
     return result;
   }
 
+  Iterator begin() {
+    return Iterator(this->front_, this);
+  }
+  Iterator end() {
+    return Iterator(nullptr, this);
+  }
+  ConstIterator begin() const {
+    return ConstIterator(this->front_, this);
+  }
+  ConstIterator end() const {
+    return ConstIterator(nullptr, this);
+  }
+
   Node* Front() {
     assert(this->size_ > 0);
     return this->front_;
@@ -146,6 +222,72 @@ class BiDirectionalList {
     delete element;
   }
 
+  // Moves all nodes of the other list in front of the element, or to the
+  // back for nullptr, in O(1).
+  void Splice(Node* element, BiDirectionalList& other) {
+    if (this != &other && other.front_ != nullptr) {
+      this->SpliceRange(element, other, other.front_, other.back_,
+                        other.size_);
+    }
+  }
+  // Moves the nodes from first to last, both included, of the other list
+  // in front of the element, or to the back for nullptr. The element must
+  // not be in the range. Counting the nodes takes linear time when they
+  // move between lists, unless their count is given.
+  void SpliceRange(Node* element, BiDirectionalList& other, Node* first,
+                   Node* last, int count = -1) {
+    if (this != &other && count < 0) {
+      count = 1;
+      for (Node* iter{first}; iter != last; iter = iter->next_) {
+        ++count;
+      }
+    }
+    other.Unlink(first, last, this == &other ? 0 : count);
+    this->Link(element, first, last, this == &other ? 0 : count);
+  }
+
+  // Stable bottom-up merge sort that relinks the nodes and allocates
+  // nothing, in O(n log n).
+  template<typename Compare = std::less<>>
+  void Sort(Compare compare = Compare()) {
+    if (this->size_ < 2) {
+      return;
+    }
+    // Run i holds 2^i nodes or none, the higher runs the earlier nodes.
+    Node* runs[64]{};
+    Node* iter{this->front_};
+    while (iter != nullptr) {
+      Node* carry{iter};
+      iter = iter->next_;
+      carry->next_ = nullptr;
+      int i{0};
+      for (; runs[i] != nullptr; ++i) {
+        carry = MergeRuns(runs[i], carry, compare);
+        runs[i] = nullptr;
+      }
+      runs[i] = carry;
+    }
+    Node* result{nullptr};
+    for (Node* run : runs) {
+      if (run != nullptr) {
+        result = MergeRuns(run, result, compare);
+      }
+    }
+    this->RelinkBackward(result);
+  }
+  // Moves the nodes of the other sorted list into this sorted one, after
+  // the equal elements here, in O(n + m).
+  template<typename Compare = std::less<>>
+  void Merge(BiDirectionalList& other, Compare compare = Compare()) {
+    if (this == &other || other.front_ == nullptr) {
+      return;
+    }
+    Node* result{MergeRuns(this->front_, other.front_, compare)};
+    this->size_ += other.size_;
+    other.ResetFields();
+    this->RelinkBackward(result);
+  }
+
   int Find(const T& value) const {
     int position{0};
     for (Node* iter{this->front_}; iter != nullptr; iter = iter->next_) {
@@ -188,7 +330,6 @@ class BiDirectionalList {
   std::stack<int, std::vector<int>> stack_on_vector;
 
   bool operator==(const BiDirectionalList& rhs) const {
-    std::cout << bool(std::cin) << std::endl;
     if (this->size_ != rhs.size_) {
       return false;
     }
@@ -264,7 +405,67 @@ class BiDirectionalList {
     }
   }
 
-  void CopyFieldsFrom(const BiDirectionalList<T> source) {
+  // Takes the nodes from first to last out of the list.
+  void Unlink(Node* first, Node* last, int count) {
+    this->size_ -= count;
+    if (first->prev_ != nullptr) {
+      first->prev_->next_ = last->next_;
+    } else {
+      this->front_ = last->next_;
+    }
+    if (last->next_ != nullptr) {
+      last->next_->prev_ = first->prev_;
+    } else {
+      this->back_ = first->prev_;
+    }
+    first->prev_ = nullptr;
+    last->next_ = nullptr;
+  }
+  // Puts the unlinked nodes from first to last in front of the element, or
+  // to the back for nullptr.
+  void Link(Node* element, Node* first, Node* last, int count) {
+    this->size_ += count;
+    Node* prev{element != nullptr ? element->prev_ : this->back_};
+    first->prev_ = prev;
+    last->next_ = element;
+    if (prev != nullptr) {
+      prev->next_ = first;
+    } else {
+      this->front_ = first;
+    }
+    if (element != nullptr) {
+      element->prev_ = last;
+    } else {
+      this->back_ = last;
+    }
+  }
+  // Merges two sorted runs linked through next_ only, taking the node from
+  // the first one on ties.
+  template<typename Compare>
+  static Node* MergeRuns(Node* first, Node* second, Compare& compare) {
+    Node* result{nullptr};
+    Node** tail{&result};
+    while (first != nullptr && second != nullptr) {
+      Node*& smaller{compare(second->value, first->value) ? second : first};
+      *tail = smaller;
+      tail = &smaller->next_;
+      smaller = smaller->next_;
+    }
+    *tail = first != nullptr ? first : second;
+    return result;
+  }
+  // Restores prev_, front_ and back_ for the nodes linked through next_.
+  void RelinkBackward(Node* front) {
+    this->front_ = front;
+    Node* prev{nullptr};
+    for (Node* iter{front}; iter != nullptr; iter = iter->next_) {
+      iter->prev_ = prev;
+      prev = iter;
+    }
+    this->back_ = prev;
+  }
+
+  void CopyFieldsFrom(const BiDirectionalList<T>& source) {
     this->front_ = source.front_;
     this->back_ = source.back_;
     this->size_ = source.size_;
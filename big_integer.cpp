@@ -1,9 +1,26 @@
 #include "big_integer.h"
 
 #include <algorithm>
-#include <cassert>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <memory_resource>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "big_integer_kernels.h"
+#include "big_integer_modular.h"
+#include "big_integer_view.h"
+#include "thread_pool.h"
 
 namespace {
 
@@ -28,14 +45,6 @@ int GetStreamBase(const S& stream) {
     }
   }
 }
-void FormatHexInput(std::string& target) {
-  // Takes input string which may be in hex format and removes the '0x' part
-  if (target[0] == '-' && target[2] == 'x') {
-    target = "-" + target.substr(3);
-  } else if (target[1] == 'x') {
-    target = target.substr(2);
-  }
-}
 
 }  // namespace
 
@@ -57,45 +66,533 @@ int CharToDigit(char ch) {
   }
   return -1;
 }
-std::string GetReversedBasePrefix(int base) {
+std::string GetBasePrefix(int base) {
   switch (base) {
     case 8: {
       return "0";
     }
     case 16: {
-      return "x0";
+      return "0x";
     }
     default: {
       return "";
     }
   }
 }
-int64_t GuessDigit(const BigInteger& lhs, const BigInteger& rhs) {
-  int64_t quotient_l_bound{0};
-  int64_t quotient_u_bound{BigInteger::internal_base};
-  while (quotient_l_bound + 1 < quotient_u_bound) {
-    int64_t middle_candidate{(quotient_l_bound + quotient_u_bound) / 2};
-    if (MultiplyByShort(rhs, middle_candidate) > lhs) {
-      quotient_u_bound = middle_candidate;
+
+template<typename Traits>
+using Limbs = std::pmr::vector<typename Traits::Limb>;
+template<typename Traits>
+using Kernels = kernels::LimbKernels<Traits>;
+
+// Below this number of limbs the radix conversion goes chunk by chunk,
+// above it the number is split in halves by a power of the base.
+constexpr size_t kRadixConversionThreshold = 60;
+// From this number of limbs on the halves are converted in parallel.
+constexpr size_t kParallelConversionThreshold = 4096;
+
+bool ShouldConvertInParallel(size_t size) {
+  return size >= kParallelConversionThreshold &&
+         concurrency::ThreadPool::Default().IsParallel();
+}
+// The resource of the callers need not be thread-safe, so the halves of a
+// parallel conversion allocate from the global heap.
+std::pmr::memory_resource* ConversionResource(
+    size_t size, std::pmr::memory_resource* resource) {
+  return ShouldConvertInParallel(size) ? std::pmr::new_delete_resource()
+                                       : resource;
+}
+
+template<typename Traits>
+Limbs<Traits> MultiplyLimbs(const Limbs<Traits>& lhs,
+                            const Limbs<Traits>& rhs) {
+  Limbs<Traits> result(lhs.size() + rhs.size(), lhs.get_allocator());
+  Limbs<Traits> scratch(
+      Kernels<Traits>::MultiplyScratchSize(lhs.size(), rhs.size()),
+      lhs.get_allocator());
+  Kernels<Traits>::Multiply(result.data(), lhs.data(), lhs.size(),
+                            rhs.data(), rhs.size(), scratch.data());
+  result.resize(Kernels<Traits>::Normalized(result.data(), result.size()));
+  return result;
+}
+
+// The largest power of a base that is at most the limb base.
+template<typename Traits>
+struct Radix {
+  explicit Radix(int base) : base(base) {
+    while (chunk <= Traits::kBase / base) {
+      chunk *= base;
+      ++chunk_digits;
+    }
+  }
+
+  int base;
+  typename Traits::WideLimb chunk{1};
+  size_t chunk_digits{0};
+};
+
+// Powers chunk^(2^i) of a value that is at most the limb base. The towers
+// are built on demand and kept per thread and chunk, as every conversion of
+// a long number needs the same powers. The levels never move once built, so
+// the tasks of a parallel conversion read them from other threads while the
+// owner may still add new ones. The powers outlive any caller's memory
+// resource, so they are kept on the global heap.
+template<typename Traits>
+class PowerTower {
+ public:
+  using Limb = typename Traits::Limb;
+  using WideLimb = typename Traits::WideLimb;
+
+  static PowerTower& For(WideLimb chunk) {
+    thread_local std::map<WideLimb, std::unique_ptr<PowerTower>> towers;
+    auto iter{towers.find(chunk)};
+    if (iter == towers.end()) {
+      iter = towers.emplace(chunk, new PowerTower(chunk)).first;
+    }
+    return *iter->second;
+  }
+
+  [[nodiscard]] Limb Chunk() const { return static_cast<Limb>(chunk_); }
+  [[nodiscard]] bool IsChunkALimb() const { return chunk_ == Traits::kBase; }
+  const Limbs<Traits>& Power(size_t level) {
+    size_t levels{this->levels_.load(std::memory_order_acquire)};
+    for (; levels <= level; ++levels) {
+      const Limbs<Traits>& last{*this->powers_[levels - 1]};
+      this->powers_[levels] =
+          std::make_unique<Limbs<Traits>>(MultiplyLimbs<Traits>(last, last));
+      this->levels_.store(levels + 1, std::memory_order_release);
+    }
+    return *this->powers_[level];
+  }
+
+ private:
+  // Enough for chunk^(2^63).
+  static constexpr size_t kMaxLevels = 64;
+
+  explicit PowerTower(WideLimb chunk) : chunk_(chunk) {
+    std::pmr::memory_resource* heap{std::pmr::new_delete_resource()};
+    powers_[0] = std::make_unique<Limbs<Traits>>(
+        IsChunkALimb() ? Limbs<Traits>({0, 1}, heap)
+                       : Limbs<Traits>({Chunk()}, heap));
+  }
+
+  WideLimb chunk_;
+  std::array<std::unique_ptr<Limbs<Traits>>, kMaxLevels> powers_;
+  std::atomic<size_t> levels_{1};
+};
+
+// Appends the little-endian digits of value in base tower.Chunk() to
+// chunks, padded with zero chunks up to count of them.
+template<typename Traits>
+void SplitIntoChunks(Limbs<Traits> value, PowerTower<Traits>& tower,
+                     size_t count, Limbs<Traits>& chunks) {
+  using K = Kernels<Traits>;
+  size_t begin{chunks.size()};
+  size_t size{K::Normalized(value.data(), value.size())};
+  if (tower.IsChunkALimb()) {
+    chunks.insert(chunks.end(), value.begin(), value.begin() + size);
+  } else if (size <= kRadixConversionThreshold) {
+    while (size > 0) {
+      chunks.push_back(K::DivideByShort(value.data(), size, tower.Chunk()));
+      size = K::Normalized(value.data(), size);
+    }
+  } else {
+    size_t level{0};
+    while (2 * tower.Power(level + 1).size() <= size + 1) {
+      ++level;
+    }
+    const Limbs<Traits>& divisor{tower.Power(level)};
+    std::pmr::memory_resource* resource{
+        ConversionResource(size, value.get_allocator().resource())};
+    Limbs<Traits> quotient(size - divisor.size() + 1, resource);
+    Limbs<Traits> remainder(divisor.size(), resource);
+    K::Divide(quotient.data(), remainder.data(), value.data(), size,
+              divisor.data(), divisor.size(), resource);
+    if (ShouldConvertInParallel(size)) {
+      Limbs<Traits> high_chunks(resource);
+      concurrency::ThreadPool::Default().Invoke(
+          [&] {
+            SplitIntoChunks(std::move(remainder), tower, size_t{1} << level,
+                            chunks);
+          },
+          [&] {
+            SplitIntoChunks(std::move(quotient), tower, 0, high_chunks);
+          });
+      chunks.insert(chunks.end(), high_chunks.begin(), high_chunks.end());
     } else {
-      quotient_l_bound = middle_candidate;
+      SplitIntoChunks(std::move(remainder), tower, size_t{1} << level,
+                      chunks);
+      SplitIntoChunks(std::move(quotient), tower, 0, chunks);
     }
   }
-  return quotient_l_bound;
+  if (chunks.size() - begin < count) {
+    chunks.resize(begin + count, 0);
+  }
 }
 
-}  // namespace
+// Converts little-endian digits in base tower.Chunk() into limbs.
+template<typename Traits>
+Limbs<Traits> ParseChunks(const typename Traits::Limb* chunks, size_t count,
+                          PowerTower<Traits>& tower,
+                          std::pmr::memory_resource* resource) {
+  using K = Kernels<Traits>;
+  if (tower.IsChunkALimb()) {
+    return Limbs<Traits>(chunks, chunks + count, resource);
+  }
+  if (count <= kRadixConversionThreshold) {
+    Limbs<Traits> result(count + 1, resource);
+    size_t size{0};
+    for (size_t i{count}; i > 0; --i) {
+      result[size] = K::MultiplyByShort(result.data(), result.data(), size,
+                                        tower.Chunk());
+      ++size;
+      K::Add(result.data(), result.data(), size, chunks + i - 1, 1);
+    }
+    result.resize(K::Normalized(result.data(), result.size()));
+    return result;
+  }
+  size_t level{0};
+  while ((size_t{2} << level) < count) {
+    ++level;
+  }
+  size_t low_count{size_t{1} << level};
+  const Limbs<Traits>& power{tower.Power(level)};
+  resource = ConversionResource(count, resource);
+  Limbs<Traits> result(resource);
+  Limbs<Traits> low(resource);
+  auto parse_high{[&] {
+    result = MultiplyLimbs<Traits>(
+        ParseChunks(chunks + low_count, count - low_count, tower, resource),
+        power);
+  }};
+  auto parse_low{[&] {
+    low = ParseChunks(chunks, low_count, tower, resource);
+  }};
+  if (ShouldConvertInParallel(count)) {
+    concurrency::ThreadPool::Default().Invoke(parse_high, parse_low);
+  } else {
+    parse_high();
+    parse_low();
+  }
+  result.resize(std::max(result.size(), low.size()) + 1);
+  K::Add(result.data(), result.data(), result.size(), low.data(), low.size());
+  result.resize(K::Normalized(result.data(), result.size()));
+  return result;
+}
+
+// With binary limbs every digit in a power-of-two base is a bit field that
+// is read or written directly.
+template<typename Traits>
+bool IsBitSliceable(int base) {
+  return std::has_single_bit(Traits::kBase) &&
+         std::has_single_bit(static_cast<unsigned>(base));
+}
+// Destinations of formatted digits.
+class StringOutput {
+ public:
+  explicit StringOutput(std::string& target) : target_(target) {}
+
+  void Put(char ch) { this->target_ += ch; }
+
+ private:
+  std::string& target_;
+};
+// Hands the characters to a stream buffer in blocks.
+class StreambufOutput {
+ public:
+  StreambufOutput(std::streambuf& buffer, bool is_uppercase)
+      : buffer_(buffer), is_uppercase_(is_uppercase) {}
+
+  // Digits and base prefixes, upper-cased if the stream asks for it.
+  void Put(char ch) {
+    this->Append(this->is_uppercase_ ? static_cast<char>(std::toupper(ch))
+                                     : ch);
+  }
+  void Put(const std::string& str) {
+    for (char ch : str) {
+      this->Put(ch);
+    }
+  }
+  // The fill character, written as it is.
+  void PutFill(char fill, size_t count) {
+    for (size_t i{0}; i < count; ++i) {
+      this->Append(fill);
+    }
+  }
+  // False once the buffer took fewer characters than it was given.
+  bool Flush() {
+    auto size{static_cast<std::streamsize>(this->size_)};
+    this->has_failed_ |= this->buffer_.sputn(this->block_.data(), size) != size;
+    this->size_ = 0;
+    return !this->has_failed_;
+  }
+
+ private:
+  void Append(char ch) {
+    if (this->size_ == this->block_.size()) {
+      this->Flush();
+    }
+    this->block_[this->size_++] = ch;
+  }
+
+  std::streambuf& buffer_;
+  bool is_uppercase_;
+  bool has_failed_{false};
+  std::array<char, 4096> block_;
+  size_t size_{0};
+};
 
-int64_t BigInteger::internal_base = 1'000'000'000;
+// The digits of a magnitude in some base, most significant first. Their
+// count is known before any of them is written, so a number is padded and
+// streamed without being formatted into a string first.
+template<typename Traits>
+class DigitFormatter {
+ public:
+  using Limb = typename Traits::Limb;
 
-BigInteger::BigInteger(int64_t value) {
-  this->SetSign(value);
-  while (value != 0) {
-    this->PushLeadingDigit(std::abs(value % internal_base));
-    value /= internal_base;
+  DigitFormatter(std::span<const Limb> value, int base,
+                 std::pmr::memory_resource* resource)
+      : value_(value), radix_(base), chunks_(resource) {
+    if (value.empty()) {
+      this->size_ = 1;
+    } else if (IsBitSliceable<Traits>(base)) {
+      this->digit_bits_ = std::countr_zero(static_cast<unsigned>(base));
+      size_t bits{(value.size() - 1) * kLimbBits +
+                  std::bit_width(value.back())};
+      this->size_ = (bits + this->digit_bits_ - 1) / this->digit_bits_;
+    } else {
+      SplitIntoChunks(Limbs<Traits>(value.begin(), value.end(), resource),
+                      PowerTower<Traits>::For(this->radix_.chunk), 0,
+                      this->chunks_);
+      this->size_ = (this->chunks_.size() - 1) * this->radix_.chunk_digits;
+      for (Limb top{this->chunks_.back()}; top != 0; top /= base) {
+        ++this->size_;
+      }
+    }
   }
+
+  [[nodiscard]] size_t Size() const { return this->size_; }
+
+  template<typename Output>
+  void WriteTo(Output& output) const {
+    if (this->value_.empty()) {
+      output.Put('0');
+    } else if (this->digit_bits_ != 0) {
+      this->WriteBitDigits(output);
+    } else {
+      for (size_t i{this->chunks_.size()}; i > 0; --i) {
+        this->WriteChunk(output, this->chunks_[i - 1],
+                         i == this->chunks_.size() ? 0
+                                                   : this->radix_.chunk_digits);
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t kLimbBits = std::numeric_limits<Limb>::digits;
+
+  // Without a width the chunk is written without leading zeroes.
+  template<typename Output>
+  void WriteChunk(Output& output, Limb chunk, size_t width) const {
+    std::array<char, kLimbBits> digits;
+    size_t count{0};
+    for (; count < width || (width == 0 && chunk != 0); ++count) {
+      digits[count] = DigitToChar(chunk % this->radix_.base);
+      chunk /= this->radix_.base;
+    }
+    while (count > 0) {
+      output.Put(digits[--count]);
+    }
+  }
+  template<typename Output>
+  void WriteBitDigits(Output& output) const {
+    for (size_t i{this->size_}; i > 0; --i) {
+      size_t position{(i - 1) * this->digit_bits_};
+      size_t limb{position / kLimbBits};
+      typename Traits::WideLimb window{this->value_[limb] >>
+                                       position % kLimbBits};
+      if (limb + 1 < this->value_.size()) {
+        window |= typename Traits::WideLimb{this->value_[limb + 1]}
+                  << (kLimbBits - position % kLimbBits);
+      }
+      output.Put(DigitToChar(
+          static_cast<int64_t>(window % this->radix_.base)));
+    }
+  }
+
+  std::span<const Limb> value_;
+  Radix<Traits> radix_;
+  // Nonzero when the digits are bit fields of the value.
+  size_t digit_bits_{0};
+  // The little-endian digits in base radix_.chunk otherwise.
+  Limbs<Traits> chunks_;
+  size_t size_{0};
+};
+
+// Assembles a magnitude from its digits in some base as they arrive, most
+// significant first. The digits are packed into chunks right away, so a
+// number is never held as a string.
+template<typename Traits>
+class DigitParser {
+ public:
+  using Limb = typename Traits::Limb;
+
+  DigitParser(int base, std::pmr::memory_resource* resource)
+      : radix_(base), chunks_(resource) {}
+
+  [[nodiscard]] bool IsEmpty() const {
+    return this->chunks_.empty() && this->pending_digits_ == 0;
+  }
+  void Push(int digit) {
+    this->pending_ = this->pending_ * this->radix_.base + digit;
+    if (++this->pending_digits_ == this->radix_.chunk_digits) {
+      this->chunks_.push_back(this->pending_);
+      this->pending_ = 0;
+      this->pending_digits_ = 0;
+    }
+  }
+  Limbs<Traits> Finish() {
+    using K = Kernels<Traits>;
+    std::reverse(this->chunks_.begin(), this->chunks_.end());
+    int base{this->radix_.base};
+    if (IsBitSliceable<Traits>(base)) {
+      return this->PackBits(std::countr_zero(static_cast<unsigned>(base)));
+    }
+    Limbs<Traits> result{ParseChunks(
+        this->chunks_.data(), this->chunks_.size(),
+        PowerTower<Traits>::For(this->radix_.chunk),
+        this->chunks_.get_allocator().resource())};
+    if (this->pending_digits_ != 0) {
+      // The digits after the last full chunk.
+      Limb scale{1};
+      for (size_t i{0}; i < this->pending_digits_; ++i) {
+        scale *= base;
+      }
+      size_t size{result.size()};
+      result.resize(size + 2, 0);
+      result[size] = K::MultiplyByShort(result.data(), result.data(), size,
+                                        scale);
+      K::Add(result.data(), result.data(), result.size(), &this->pending_, 1);
+      result.resize(K::Normalized(result.data(), result.size()));
+    }
+    return result;
+  }
+
+ private:
+  static constexpr size_t kLimbBits = std::numeric_limits<Limb>::digits;
+
+  Limbs<Traits> PackBits(size_t digit_bits) {
+    Limbs<Traits> result(this->chunks_.get_allocator());
+    result.reserve(this->chunks_.size() + 1);
+    typename Traits::WideLimb accumulator{this->pending_};
+    size_t filled{this->pending_digits_ * digit_bits};
+    size_t chunk_bits{this->radix_.chunk_digits * digit_bits};
+    for (Limb chunk : this->chunks_) {
+      accumulator |= typename Traits::WideLimb{chunk} << filled;
+      filled += chunk_bits;
+      while (filled >= kLimbBits) {
+        result.push_back(static_cast<Limb>(accumulator));
+        accumulator >>= kLimbBits;
+        filled -= kLimbBits;
+      }
+    }
+    result.push_back(static_cast<Limb>(accumulator));
+    return result;
+  }
+
+  Radix<Traits> radix_;
+  // The full chunks, most significant first until Finish.
+  Limbs<Traits> chunks_;
+  Limb pending_{0};
+  size_t pending_digits_{0};
+};
+
+// The binary format of BasicBigInteger::Serialize.
+constexpr size_t kSerializedHeaderSize = 8;
+constexpr uint32_t kNegativeFlag = 1;
+constexpr uint32_t kBinaryLimbsFlag = 2;
+
+template<typename Traits>
+constexpr bool kHasBinaryLimbs{Traits::kBase == BinaryLimbs::kBase};
+
+void StoreWord(std::byte* output, uint32_t word) {
+  for (size_t i{0}; i < sizeof(word); ++i) {
+    output[i] = static_cast<std::byte>(word >> (8 * i));
+  }
+}
+uint32_t LoadWord(const std::byte* input) {
+  uint32_t word{0};
+  for (size_t i{0}; i < sizeof(word); ++i) {
+    word |= std::to_integer<uint32_t>(input[i]) << (8 * i);
+  }
+  return word;
+}
+
+struct SerializedHeader {
+  bool is_negative;
+  bool has_binary_limbs;
+  size_t size;
+};
+SerializedHeader ReadSerializedHeader(std::span<const std::byte> input) {
+  if (input.size() < kSerializedHeaderSize) {
+    throw std::runtime_error("Truncated BigInteger");
+  }
+  uint32_t flags{LoadWord(input.data())};
+  size_t size{LoadWord(input.data() + 4)};
+  if ((flags & ~(kNegativeFlag | kBinaryLimbsFlag)) != 0 ||
+      input.size() - kSerializedHeaderSize != size * sizeof(uint32_t)) {
+    throw std::runtime_error("Malformed BigInteger");
+  }
+  return {(flags & kNegativeFlag) != 0, (flags & kBinaryLimbsFlag) != 0,
+          size};
+}
+
+template<typename Traits>
+bool AreValidLimbs(std::span<const typename Traits::Limb> limbs) {
+  if constexpr (kHasBinaryLimbs<Traits>) {
+    return true;
+  } else {
+    return std::all_of(limbs.begin(), limbs.end(), [](auto limb) {
+      return limb < Traits::kBase;
+    });
+  }
+}
+
+}  // namespace
+
+template<typename Traits>
+BasicBigInteger<Traits>::BasicBigInteger(int64_t value,
+                                         std::pmr::memory_resource* resource)
+    : digits_(resource), is_negative(value < 0) {
+  Limb limbs[kInt64Limbs];
+  this->digits_.assign(limbs, limbs + ToLimbs(value, limbs));
+}
+template<typename Traits>
+template<typename OtherTraits>
+BasicBigInteger<Traits>::BasicBigInteger(
+    const BasicBigInteger<OtherTraits>& other)
+    : digits_(other.Resource()), is_negative(other.is_negative) {
+  std::pmr::memory_resource* resource{other.Resource()};
+  if constexpr (OtherTraits::kBase == Traits::kBase) {
+    this->digits_.assign(other.digits_.begin(), other.digits_.end());
+  } else if constexpr (OtherTraits::kBase < Traits::kBase) {
+    Limbs<Traits> limbs{ParseChunks<Traits>(
+        other.digits_.data(), other.digits_.size(),
+        PowerTower<Traits>::For(OtherTraits::kBase), resource)};
+    this->digits_.assign(limbs.begin(), limbs.end());
+  } else {
+    Limbs<Traits> limbs(resource);
+    SplitIntoChunks<OtherTraits>(
+        Limbs<OtherTraits>(other.digits_.begin(), other.digits_.end(),
+                           resource),
+        PowerTower<OtherTraits>::For(Traits::kBase), 0, limbs);
+    this->digits_.assign(limbs.begin(), limbs.end());
+  }
+  this->RemoveZeroes();
 }
-BigInteger BigInteger::FromString(const std::string& input, int base) {
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::FromString(
+    const std::string& input, int base, std::pmr::memory_resource* resource) {
   ThrowIfBaseIsInvalid(base);
 
   for (size_t i{0}; i < input.size(); i++) {
@@ -107,249 +604,469 @@ BigInteger BigInteger::FromString(const std::string& input, int base) {
       throw std::runtime_error("Invalid symbol at index " + std::to_string(i));
     }
   }
-  BigInteger result{0};
-  BigInteger base_power{1};
-  for (auto iter{input.rbegin()}; iter < input.rend(); iter++) {
-    if (*iter == '-') {
-      continue;
+  bool is_negative{!input.empty() && input[0] == '-'};
+  DigitParser<Traits> parser(base, resource);
+  for (size_t i{is_negative ? size_t{1} : size_t{0}}; i < input.size(); ++i) {
+    parser.Push(CharToDigit(input[i]));
+  }
+  Limbs<Traits> limbs{parser.Finish()};
+  BasicBigInteger result(0, resource);
+  result.digits_.assign(limbs.begin(), limbs.end());
+  result.RemoveZeroes();
+  result.is_negative = is_negative;
+  return result;
+}
+
+template<typename Traits>
+BasicBigInteger<Traits>::BasicBigInteger(View value)
+    : is_negative(value.Sign() < 0) {
+  this->digits_.assign(value.Magnitude().begin(), value.Magnitude().end());
+}
+
+template<typename Traits>
+size_t BasicBigInteger<Traits>::ExportLimbs(std::span<Limb> output) const {
+  if (output.size() < this->digits_.size()) {
+    throw std::length_error("Limb buffer is too short");
+  }
+  std::copy(this->digits_.begin(), this->digits_.end(), output.begin());
+  return this->digits_.size();
+}
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::ImportLimbs(
+    std::span<const Limb> limbs, bool is_negative,
+    std::pmr::memory_resource* resource) {
+  if (!AreValidLimbs<Traits>(limbs)) {
+    throw std::logic_error("Invalid limb");
+  }
+  BasicBigInteger result(0, resource);
+  result.digits_.assign(limbs.begin(), limbs.end());
+  result.RemoveZeroes();
+  result.is_negative = is_negative && result.Sign() != 0;
+  return result;
+}
+
+template<typename Traits>
+size_t BasicBigInteger<Traits>::SerializedSize() const {
+  return kSerializedHeaderSize + this->digits_.size() * sizeof(Limb);
+}
+template<typename Traits>
+size_t BasicBigInteger<Traits>::Serialize(std::span<std::byte> output) const {
+  static_assert(sizeof(Limb) == sizeof(uint32_t));
+  size_t size{this->SerializedSize()};
+  if (output.size() < size) {
+    throw std::length_error("Output buffer is too short");
+  }
+  uint32_t flags{(this->Sign() < 0 ? kNegativeFlag : 0) |
+                 (kHasBinaryLimbs<Traits> ? kBinaryLimbsFlag : 0)};
+  StoreWord(output.data(), flags);
+  StoreWord(output.data() + 4, static_cast<uint32_t>(this->digits_.size()));
+  std::byte* limbs{output.data() + kSerializedHeaderSize};
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(limbs, this->digits_.data(),
+                this->digits_.size() * sizeof(Limb));
+  } else {
+    for (size_t i{0}; i < this->digits_.size(); ++i) {
+      StoreWord(limbs + i * sizeof(Limb), this->digits_[i]);
+    }
+  }
+  return size;
+}
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::Deserialize(
+    std::span<const std::byte> input) {
+  SerializedHeader header{ReadSerializedHeader(input)};
+  if (header.has_binary_limbs != kHasBinaryLimbs<Traits>) {
+    using OtherTraits = std::conditional_t<kHasBinaryLimbs<Traits>,
+                                           DecimalLimbs, BinaryLimbs>;
+    return BasicBigInteger(BasicBigInteger<OtherTraits>::Deserialize(input));
+  }
+  BasicBigInteger result;
+  result.digits_.resize(header.size);
+  const std::byte* limbs{input.data() + kSerializedHeaderSize};
+  if constexpr (std::endian::native == std::endian::little) {
+    std::memcpy(result.digits_.data(), limbs, header.size * sizeof(Limb));
+  } else {
+    for (size_t i{0}; i < header.size; ++i) {
+      result.digits_[i] = LoadWord(limbs + i * sizeof(Limb));
     }
-    result += MultiplyByShort(base_power, CharToDigit(*iter));
-    base_power = MultiplyByShort(base_power, base);
   }
-  return input[0] == '-' ? -result : result;
+  if (!AreValidLimbs<Traits>(result.Magnitude())) {
+    throw std::runtime_error("Malformed BigInteger");
+  }
+  result.RemoveZeroes();
+  result.is_negative = header.is_negative && result.Sign() != 0;
+  return result;
 }
 
-std::string BigInteger::ToString(int base, bool should_show_base) const {
+template<typename Traits>
+std::string BasicBigInteger<Traits>::ToString(int base,
+                                              bool should_show_base) const {
   ThrowIfBaseIsInvalid(base);
-  std::string reversed_result{*this == 0 ? "0" : ""};
-  BigInteger temp{*this};
-  temp.Abs();
-  while (temp != 0) {
-    int64_t digit{int64_t(temp - MultiplyByShort(temp / base, base))};
-    reversed_result += DigitToChar(digit);
-    temp /= base;
+  DigitFormatter<Traits> digits(this->Magnitude(), base, this->Resource());
+  std::string result;
+  result.reserve(digits.Size() + 3);
+  if (this->Sign() < 0) {
+    result += '-';
   }
   if (should_show_base) {
-    reversed_result += GetReversedBasePrefix(base);
-  }
-  if (*this < 0) {
-    reversed_result += '-';
+    result += GetBasePrefix(base);
   }
-  std::reverse(reversed_result.begin(), reversed_result.end());
-  return reversed_result;
+  StringOutput output(result);
+  digits.WriteTo(output);
+  return result;
 }
 
-bool BigInteger::operator==(const BigInteger& rhs) const {
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator==(const BasicBigInteger& rhs) const {
   if (this->Sign() != rhs.Sign()) {
     return false;
   }
   return CompareAbsoluteValues(*this, rhs) == 0;
 }
-bool BigInteger::operator!=(const BigInteger& rhs) const {
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator!=(const BasicBigInteger& rhs) const {
   return !(*this == rhs);
 }
-bool BigInteger::operator<(const BigInteger& rhs) const {
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator<(const BasicBigInteger& rhs) const {
   if (this->Sign() != rhs.Sign()) {
     return this->Sign() < rhs.Sign();
   }
   return CompareAbsoluteValues(*this, rhs) * this->Sign() == -1;
 }
-bool BigInteger::operator>(const BigInteger& rhs) const {
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator>(const BasicBigInteger& rhs) const {
   return !(*this == rhs || *this < rhs);
 }
-bool BigInteger::operator<=(const BigInteger& rhs) const {
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator<=(const BasicBigInteger& rhs) const {
   return *this == rhs || *this < rhs;
 }
-bool BigInteger::operator>=(const BigInteger& rhs) const {
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator>=(const BasicBigInteger& rhs) const {
   return !(*this < rhs);
 }
 
-bool BigInteger::operator==(int64_t rhs) const {
-  return *this == BigInteger(rhs);
-}
-bool BigInteger::operator!=(int64_t rhs) const {
-  return *this != BigInteger(rhs);
-}
-bool BigInteger::operator<(int64_t rhs) const {
-  return *this < BigInteger(rhs);
-}
-bool BigInteger::operator>(int64_t rhs) const {
-  return *this > BigInteger(rhs);
-}
-bool BigInteger::operator<=(int64_t rhs) const {
-  return *this <= BigInteger(rhs);
-}
-bool BigInteger::operator>=(int64_t rhs) const {
-  return *this >= BigInteger(rhs);
-}
-
-bool operator==(int64_t lhs, const BigInteger& rhs) {
-  return rhs == lhs;
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator==(int64_t rhs) const {
+  return this->CompareWith(rhs) == 0;
 }
-bool operator!=(int64_t lhs, const BigInteger& rhs) {
-  return rhs != lhs;
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator!=(int64_t rhs) const {
+  return this->CompareWith(rhs) != 0;
 }
-bool operator<(int64_t lhs, const BigInteger& rhs) {
-  return rhs > lhs;
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator<(int64_t rhs) const {
+  return this->CompareWith(rhs) < 0;
 }
-bool operator>(int64_t lhs, const BigInteger& rhs) {
-  return rhs < lhs;
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator>(int64_t rhs) const {
+  return this->CompareWith(rhs) > 0;
 }
-bool operator<=(int64_t lhs, const BigInteger& rhs) {
-  return rhs >= lhs;
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator<=(int64_t rhs) const {
+  return this->CompareWith(rhs) <= 0;
 }
-bool operator>=(int64_t lhs, const BigInteger& rhs) {
-  return rhs <= lhs;
+template<typename Traits>
+bool BasicBigInteger<Traits>::operator>=(int64_t rhs) const {
+  return this->CompareWith(rhs) >= 0;
 }
 
-BigInteger& BigInteger::operator+=(int64_t value) {
-  return *this += BigInteger(value);
-}
-BigInteger& BigInteger::operator-=(int64_t value) {
-  return *this -= BigInteger(value);
-}
-BigInteger& BigInteger::operator*=(int64_t value) {
-  return *this *= BigInteger(value);
-}
-BigInteger& BigInteger::operator/=(int64_t value) {
-  return *this /= BigInteger(value);
-}
-
-BigInteger& BigInteger::operator+=(const BigInteger& rhs) {
-  return *this = *this + rhs;
-}
-BigInteger& BigInteger::operator-=(const BigInteger& rhs) {
-  return *this = *this - rhs;
-}
-BigInteger& BigInteger::operator*=(const BigInteger& rhs) {
-  return *this = *this * rhs;
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator+=(int64_t value) {
+  Limb limbs[kInt64Limbs];
+  this->AddSigned(limbs, ToLimbs(value, limbs), value < 0);
+  return *this;
+}
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator-=(int64_t value) {
+  Limb limbs[kInt64Limbs];
+  this->AddSigned(limbs, ToLimbs(value, limbs), value > 0);
+  return *this;
+}
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator*=(int64_t value) {
+  if (!FitsIntoLimb(value)) {
+    return *this *= BasicBigInteger(value);
+  }
+  if (value < 0) {
+    this->Negate();
+  }
+  this->MultiplyByLimb(static_cast<Limb>(std::abs(value)));
+  return *this;
 }
-BigInteger& BigInteger::operator/=(const BigInteger& rhs) {
-  return *this = *this / rhs;
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator/=(int64_t value) {
+  if (value == 0) {
+    throw DivisionByZeroError();
+  }
+  if (!FitsIntoLimb(value)) {
+    return *this /= BasicBigInteger(value);
+  }
+  if (value < 0) {
+    this->Negate();
+  }
+  this->DivideByLimb(static_cast<Limb>(std::abs(value)));
+  return *this;
 }
 
-BigInteger BigInteger::operator+(int64_t rhs) const {
-  return *this + BigInteger(rhs);
-}
-BigInteger BigInteger::operator-(int64_t rhs) const {
-  return *this - BigInteger(rhs);
-}
-BigInteger BigInteger::operator*(int64_t rhs) const {
-  return *this * BigInteger(rhs);
+template<typename Traits>
+BasicBigInteger<Traits>&
+BasicBigInteger<Traits>::operator+=(const BasicBigInteger& rhs) {
+  if (this == &rhs) {
+    this->MultiplyByLimb(2);
+  } else {
+    this->AddSigned(rhs.digits_.data(), rhs.digits_.size(), rhs.is_negative);
+  }
+  return *this;
 }
-BigInteger BigInteger::operator/(int64_t rhs) const {
-  return *this / BigInteger(rhs);
+template<typename Traits>
+BasicBigInteger<Traits>&
+BasicBigInteger<Traits>::operator-=(const BasicBigInteger& rhs) {
+  if (this == &rhs) {
+    this->digits_.clear();
+  } else {
+    this->AddSigned(rhs.digits_.data(), rhs.digits_.size(), !rhs.is_negative);
+  }
+  return *this;
+}
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator+=(View rhs) {
+  // A view of this value may dangle once the limbs grow.
+  std::less<const Limb*> is_before;
+  const Limb* limbs{rhs.Magnitude().data()};
+  if (!is_before(limbs, this->digits_.data()) &&
+      is_before(limbs, this->digits_.data() + this->digits_.capacity())) {
+    return *this += BasicBigInteger(rhs);
+  }
+  this->AddSigned(limbs, rhs.Magnitude().size(), rhs.Sign() < 0);
+  return *this;
+}
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator-=(View rhs) {
+  std::less<const Limb*> is_before;
+  const Limb* limbs{rhs.Magnitude().data()};
+  if (!is_before(limbs, this->digits_.data()) &&
+      is_before(limbs, this->digits_.data() + this->digits_.capacity())) {
+    return *this -= BasicBigInteger(rhs);
+  }
+  this->AddSigned(limbs, rhs.Magnitude().size(), rhs.Sign() > 0);
+  return *this;
+}
+template<typename Traits>
+BasicBigInteger<Traits>&
+BasicBigInteger<Traits>::operator*=(const BasicBigInteger& rhs) {
+  if (rhs.NumberOfDigits() != 1) {
+    return *this = *this * rhs;
+  }
+  bool is_negative{this->is_negative != rhs.is_negative};
+  this->MultiplyByLimb(rhs.digits_[0]);
+  this->is_negative = is_negative;
+  return *this;
+}
+template<typename Traits>
+BasicBigInteger<Traits>&
+BasicBigInteger<Traits>::operator/=(const BasicBigInteger& rhs) {
+  if (rhs.NumberOfDigits() != 1) {
+    return *this = *this / rhs;
+  }
+  bool is_negative{this->is_negative != rhs.is_negative};
+  this->DivideByLimb(rhs.digits_[0]);
+  this->is_negative = is_negative;
+  return *this;
 }
 
-BigInteger operator+(int64_t lhs, const BigInteger& rhs) {
-  return BigInteger(lhs) + rhs;
-}
-BigInteger operator-(int64_t lhs, const BigInteger& rhs) {
-  return BigInteger(lhs) - rhs;
-}
-BigInteger operator*(int64_t lhs, const BigInteger& rhs) {
-  return BigInteger(lhs) * rhs;
-}
-BigInteger operator/(int64_t lhs, const BigInteger& rhs) {
-  return BigInteger(lhs) / rhs;
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::operator+(int64_t rhs) const {
+  BasicBigInteger result{*this};
+  return result += rhs;
+}
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::operator-(int64_t rhs) const {
+  BasicBigInteger result{*this};
+  return result -= rhs;
+}
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::operator*(int64_t rhs) const {
+  BasicBigInteger result{*this};
+  return result *= rhs;
+}
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::operator/(int64_t rhs) const {
+  BasicBigInteger result{*this};
+  return result /= rhs;
 }
 
-BigInteger BigInteger::operator+(const BigInteger& rhs) const {
-  if (CompareAbsoluteValues(*this, rhs) == -1) {
-    return rhs + *this;
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator+(const BasicBigInteger& rhs) const& {
+  // Adding the shorter operand to a copy of the longer one, which is made
+  // in the resource of lhs either way.
+  if (rhs.NumberOfDigits() > this->NumberOfDigits()) {
+    BasicBigInteger result{rhs, this->Resource()};
+    return result += *this;
+  }
+  BasicBigInteger result{*this};
+  return result += rhs;
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator+(const BasicBigInteger& rhs) && {
+  *this += rhs;
+  return std::move(*this);
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator+(BasicBigInteger&& rhs) const& {
+  if (*rhs.Resource() != *this->Resource()) {
+    return *this + std::as_const(rhs);
   }
-  if (*this < 0) {
-    return -(-*this + -rhs);
+  rhs += *this;
+  return std::move(rhs);
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator+(BasicBigInteger&& rhs) && {
+  if (rhs.digits_.capacity() > this->digits_.capacity() &&
+      *rhs.Resource() == *this->Resource()) {
+    rhs += *this;
+    return std::move(rhs);
   }
-  BigInteger result;
-  int64_t carry{0};
-  for (size_t i{0}; i < this->NumberOfDigits() || carry != 0; i++) {
-    int64_t digit{carry};
-    if (i < this->NumberOfDigits()) {
-      digit += this->DigitAt(i);
+  *this += rhs;
+  return std::move(*this);
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator-(const BasicBigInteger& rhs) const& {
+  BasicBigInteger result{*this};
+  return result -= rhs;
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator-(const BasicBigInteger& rhs) && {
+  *this -= rhs;
+  return std::move(*this);
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator-(BasicBigInteger&& rhs) const& {
+  if (*rhs.Resource() != *this->Resource()) {
+    return *this - std::as_const(rhs);
+  }
+  rhs -= *this;
+  rhs.Negate();
+  return std::move(rhs);
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator-(BasicBigInteger&& rhs) && {
+  *this -= rhs;
+  return std::move(*this);
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator*(const BasicBigInteger& rhs) const {
+  return View::Product(*this, rhs, this->Resource());
+}
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator/(const BasicBigInteger& rhs) const {
+  return View::Divide(*this, rhs, false, this->Resource()).first;
+}
+
+template<typename Traits>
+BasicBigInteger<Traits>
+BasicBigInteger<Traits>::operator%(const BasicBigInteger& rhs) const {
+  return DivMod(*this, rhs).second;
+}
+template<typename Traits>
+BasicBigInteger<Traits>&
+BasicBigInteger<Traits>::operator%=(const BasicBigInteger& rhs) {
+  return *this = DivMod(*this, rhs).second;
+}
+template<typename Traits>
+std::pair<BasicBigInteger<Traits>, BasicBigInteger<Traits>>
+BasicBigInteger<Traits>::DivMod(const BasicBigInteger& dividend,
+                                const BasicBigInteger& divisor) {
+  return View::Divide(dividend, divisor, true, dividend.Resource());
+}
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::Pow(
+    const BasicBigInteger& base, uint64_t exponent) {
+  BasicBigInteger result(1, base.Resource());
+  BasicBigInteger power{base};
+  while (exponent != 0) {
+    if (exponent & 1) {
+      result *= power;
     }
-    if (i < rhs.NumberOfDigits()) {
-      digit += rhs.SignedDigitAt(i);
+    exponent >>= 1;
+    if (exponent != 0) {
+      power *= power;
     }
-    result.PushLeadingDigit(RemainderByBase(digit));
-    carry = (digit - result.LeadingDigit()) / internal_base;
   }
-  result.RemoveZeroes();
   return result;
 }
-BigInteger BigInteger::operator-(const BigInteger& rhs) const {
-  return *this < 0 ? -(-*this + rhs) : *this + -rhs;
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::PowMod(
+    const BasicBigInteger& base, const BasicBigInteger& exponent,
+    const BasicBigInteger& modulus) {
+  return BasicModContext<Traits>(modulus).Pow(base, exponent);
 }
-BigInteger BigInteger::operator*(const BigInteger& rhs) const {
-  if (*this < 0) {
-    return -(-*this * rhs);
-  }
-  if (rhs < 0) {
-    return -(*this * -rhs);
-  }
-  BigInteger result{0};
-  for (ssize_t i{0}; i < rhs.NumberOfDigits(); i++) {
-    BigInteger lhs_times_digit{MultiplyByShort(*this, rhs.DigitAt(i))};
-    lhs_times_digit.InsertLeastSignificantDigit(0, i);
-    result += lhs_times_digit;
-  }
-  result.RemoveZeroes();
-  return result;
-}
-BigInteger BigInteger::operator/(const BigInteger& rhs) const {
+
+template<typename Traits>
+uint32_t BasicBigInteger<Traits>::operator%(uint32_t rhs) const {
   if (rhs == 0) {
     throw DivisionByZeroError();
   }
-  if (*this < 0) {
-    return -(-*this / rhs);
-  }
-  if (rhs < 0) {
-    return -(*this / -rhs);
-  }
-  // Inspired by the traditional soviet 'Delenie ugolkom' algorithm :)
-
-  // The result is stored in reverse to provide O(1) insertion of
-  // least significant digit. The result is then reversed before returning.
-  BigInteger reversed_result{0};
-  BigInteger trailing_dividend{0};
-  for (ssize_t i{this->NumberOfDigits() - 1}; i >= 0; i--) {
-    trailing_dividend.InsertLeastSignificantDigit(this->DigitAt(i));
-    int64_t digit{GuessDigit(trailing_dividend, rhs)};
-    reversed_result.PushDigitToEnd(digit);
-    trailing_dividend -= MultiplyByShort(rhs, digit);
+  int64_t remainder;
+  if (FitsIntoLimb(rhs)) {
+    remainder = Kernels<Traits>::RemainderByShort(
+        this->digits_.data(), this->digits_.size(), static_cast<Limb>(rhs));
+    if (this->is_negative) {
+      remainder = -remainder;
+    }
+  } else {
+    remainder =
+        static_cast<int64_t>(DivMod(*this, BasicBigInteger(rhs)).second);
   }
-  reversed_result.ReverseDigitsAndNormalize();
-  return reversed_result;
-}
-
-uint32_t BigInteger::operator%(uint32_t rhs) const {
-  return (int64_t(*this - (*this / rhs) * rhs) + rhs) % rhs;
+  return static_cast<uint32_t>((remainder + rhs) % rhs);
 }
 
-const BigInteger BigInteger::operator++(int) {
-  BigInteger temp{*this};
+template<typename Traits>
+const BasicBigInteger<Traits> BasicBigInteger<Traits>::operator++(int) {
+  BasicBigInteger temp{*this};
   *this += 1;
   return temp;
 }
-BigInteger& BigInteger::operator++() {
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator++() {
   return *this += 1;
 }
-const BigInteger BigInteger::operator--(int) {
-  BigInteger temp{*this};
+template<typename Traits>
+const BasicBigInteger<Traits> BasicBigInteger<Traits>::operator--(int) {
+  BasicBigInteger temp{*this};
   *this -= 1;
   return temp;
 }
-BigInteger& BigInteger::operator--() {
+template<typename Traits>
+BasicBigInteger<Traits>& BasicBigInteger<Traits>::operator--() {
   return *this -= 1;
 }
 
-BigInteger BigInteger::operator-() const {
-  BigInteger temp{*this};
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::operator-() const& {
+  BasicBigInteger temp{*this};
   temp.Negate();
   return temp;
 }
+template<typename Traits>
+BasicBigInteger<Traits> BasicBigInteger<Traits>::operator-() && {
+  this->Negate();
+  return std::move(*this);
+}
 
-BigInteger::operator int64_t() const {
+template<typename Traits>
+BasicBigInteger<Traits>::operator int64_t() const {
   if (*this > INT64_MAX || *this < INT64_MIN) {
     throw std::runtime_error("int64_t overflow");
   }
@@ -357,133 +1074,323 @@ BigInteger::operator int64_t() const {
   int64_t power{1};
   for (auto digit : this->digits_) {
     result += digit * power;
-    if (BigInteger(power) * internal_base <= INT64_MAX) {
+    if (BasicBigInteger(power) * internal_base <= INT64_MAX) {
       power *= internal_base;
     }
   }
   return result * this->Sign();
 }
 
-int64_t BigInteger::DigitAt(size_t pos) const { return this->digits_.at(pos); }
-int64_t& BigInteger::DigitAt(size_t pos) { return this->digits_.at(pos); }
-int64_t BigInteger::SignedDigitAt(size_t pos) const {
-  return this->Sign() * this->DigitAt(pos);
-}
-ssize_t BigInteger::NumberOfDigits() const { return this->digits_.size(); }
-int64_t BigInteger::LeadingDigit() const {
-  return this->digits_.back();
+template<typename Traits>
+ssize_t BasicBigInteger<Traits>::NumberOfDigits() const {
+  return this->digits_.size();
 }
 
-void BigInteger::RemoveZeroes() {
-  ssize_t rightmost_nonzero;
-  for (rightmost_nonzero = this->NumberOfDigits() - 1; rightmost_nonzero >= 0;
-       rightmost_nonzero--) {
-    if (this->DigitAt(rightmost_nonzero) != 0) {
-      break;
-    }
-  }
-  this->digits_.resize(rightmost_nonzero + 1);
+template<typename Traits>
+void BasicBigInteger<Traits>::RemoveZeroes() {
+  this->digits_.resize(Kernels<Traits>::Normalized(this->digits_.data(),
+                                                   this->digits_.size()));
 }
-void BigInteger::SetSign(int64_t value) {
-  this->is_negative = value < 0;
-}
-void BigInteger::InsertLeastSignificantDigit(int64_t digit) {
-  this->digits_.insert(this->digits_.begin(), digit);
+template<typename Traits>
+void BasicBigInteger<Traits>::PushLeadingDigit(Limb digit) {
+  this->digits_.push_back(digit);
 }
-void BigInteger::InsertLeastSignificantDigit(int64_t digit, int64_t quantity) {
-  this->digits_.insert(this->digits_.begin(), quantity, digit);
+
+template<typename Traits>
+bool BasicBigInteger<Traits>::FitsIntoLimb(int64_t value) {
+  return value > -internal_base && value < internal_base;
+}
+template<typename Traits>
+size_t BasicBigInteger<Traits>::ToLimbs(int64_t value, Limb* limbs) {
+  uint64_t magnitude{value < 0 ? 0 - static_cast<uint64_t>(value)
+                               : static_cast<uint64_t>(value)};
+  size_t size{0};
+  while (magnitude != 0) {
+    limbs[size++] = static_cast<Limb>(magnitude % Traits::kBase);
+    magnitude /= Traits::kBase;
+  }
+  return size;
 }
-void BigInteger::PushLeadingDigit(int64_t digit) {
-  this->digits_.push_back(digit);
+template<typename Traits>
+int BasicBigInteger<Traits>::CompareWith(int64_t value) const {
+  int value_sign{value < 0 ? -1 : value > 0 ? 1 : 0};
+  if (this->Sign() != value_sign) {
+    return this->Sign() < value_sign ? -1 : 1;
+  }
+  Limb limbs[kInt64Limbs];
+  size_t size{ToLimbs(value, limbs)};
+  return Kernels<Traits>::Compare(this->digits_.data(), this->digits_.size(),
+                                  limbs, size) * value_sign;
+}
+template<typename Traits>
+void BasicBigInteger<Traits>::AddSigned(const Limb* rhs_data, size_t rhs_size,
+                                        bool rhs_is_negative) {
+  using K = Kernels<Traits>;
+  size_t lhs_size{this->digits_.size()};
+  if (this->is_negative == rhs_is_negative) {
+    this->digits_.resize(std::max(lhs_size, rhs_size) + 1);
+    Limb* data{this->digits_.data()};
+    if (lhs_size >= rhs_size) {
+      data[lhs_size] = K::Add(data, data, lhs_size, rhs_data, rhs_size);
+    } else {
+      data[rhs_size] = K::Add(data, rhs_data, rhs_size, data, lhs_size);
+    }
+  } else if (K::Compare(this->digits_.data(), lhs_size,
+                        rhs_data, rhs_size) >= 0) {
+    Limb* data{this->digits_.data()};
+    K::Subtract(data, data, lhs_size, rhs_data, rhs_size);
+  } else {
+    this->digits_.resize(rhs_size);
+    Limb* data{this->digits_.data()};
+    K::Subtract(data, rhs_data, rhs_size, data, lhs_size);
+    this->Negate();
+  }
+  this->RemoveZeroes();
 }
-void BigInteger::PushDigitToEnd(int64_t digit) {
-  this->digits_.push_back(digit);
+template<typename Traits>
+void BasicBigInteger<Traits>::MultiplyByLimb(Limb multiplier) {
+  Limb* data{this->digits_.data()};
+  Limb carry{Kernels<Traits>::MultiplyByShort(data, data, this->digits_.size(),
+                                              multiplier)};
+  if (carry != 0) {
+    this->PushLeadingDigit(carry);
+  }
+  this->RemoveZeroes();
 }
-void BigInteger::ReverseDigitsAndNormalize() {
-  std::reverse(this->digits_.begin(), this->digits_.end());
+template<typename Traits>
+typename BasicBigInteger<Traits>::Limb
+BasicBigInteger<Traits>::DivideByLimb(Limb divisor) {
+  Limb remainder{Kernels<Traits>::DivideByShort(
+      this->digits_.data(), this->digits_.size(), divisor)};
   this->RemoveZeroes();
+  return remainder;
+}
+template<typename Traits>
+int BasicBigInteger<Traits>::CompareAbsoluteValues(
+    const BasicBigInteger& lhs, const BasicBigInteger& rhs) {
+  return Kernels<Traits>::Compare(lhs.digits_.data(), lhs.digits_.size(),
+                                 rhs.digits_.data(), rhs.digits_.size());
 }
 
-int64_t BigInteger::RemainderByBase(int64_t number) {
-  return ((number % internal_base) + internal_base) % internal_base;
+template<typename Traits>
+BasicBigIntegerView<Traits>::BasicBigIntegerView(std::span<const Limb> limbs,
+                                                 bool is_negative)
+    : limbs_(limbs.first(Kernels<Traits>::Normalized(limbs.data(),
+                                                     limbs.size()))),
+      is_negative_(is_negative) {}
+template<typename Traits>
+BasicBigIntegerView<Traits> BasicBigIntegerView<Traits>::FromSerialized(
+    std::span<const std::byte> input) {
+  SerializedHeader header{ReadSerializedHeader(input)};
+  if (header.has_binary_limbs != kHasBinaryLimbs<Traits>) {
+    throw std::runtime_error("Serialized limbs are of another base");
+  }
+  const std::byte* data{input.data() + kSerializedHeaderSize};
+  if (std::endian::native != std::endian::little ||
+      reinterpret_cast<uintptr_t>(data) % alignof(Limb) != 0) {
+    throw std::runtime_error("Serialized limbs can't be viewed in place");
+  }
+  std::span<const Limb> limbs(reinterpret_cast<const Limb*>(data),
+                              header.size);
+  if (!AreValidLimbs<Traits>(limbs)) {
+    throw std::runtime_error("Malformed BigInteger");
+  }
+  return BasicBigIntegerView(limbs, header.is_negative);
 }
-BigInteger MultiplyByShort(const BigInteger& lhs, int64_t rhs) {
-  BigInteger result;
-  int64_t carry{0};
-  for (ssize_t i{0}; i < lhs.NumberOfDigits() || carry != 0; i++) {
-    int64_t digit{carry};
-    if (i < lhs.NumberOfDigits()) {
-      digit += lhs.DigitAt(i) * rhs;
-    }
-    result.PushLeadingDigit(digit % BigInteger::internal_base);
-    carry = digit / BigInteger::internal_base;
+
+template<typename Traits>
+int BasicBigIntegerView<Traits>::Compare(BasicBigIntegerView lhs,
+                                         BasicBigIntegerView rhs) {
+  if (lhs.Sign() != rhs.Sign()) {
+    return lhs.Sign() < rhs.Sign() ? -1 : 1;
   }
+  int result{Kernels<Traits>::Compare(lhs.limbs_.data(), lhs.limbs_.size(),
+                                      rhs.limbs_.data(), rhs.limbs_.size())};
+  return lhs.Sign() < 0 ? -result : result;
+}
+template<typename Traits>
+typename BasicBigIntegerView<Traits>::Integer
+BasicBigIntegerView<Traits>::Product(BasicBigIntegerView lhs,
+                                     BasicBigIntegerView rhs,
+                                     std::pmr::memory_resource* resource) {
+  Integer result(0, resource);
+  if (lhs.Sign() == 0 || rhs.Sign() == 0) {
+    return result;
+  }
+  size_t lhs_size{lhs.limbs_.size()};
+  size_t rhs_size{rhs.limbs_.size()};
+  result.digits_.resize(lhs_size + rhs_size);
+  Limbs<Traits> scratch(
+      Kernels<Traits>::MultiplyScratchSize(lhs_size, rhs_size), resource);
+  Kernels<Traits>::Multiply(result.digits_.data(), lhs.limbs_.data(),
+                            lhs_size, rhs.limbs_.data(), rhs_size,
+                            scratch.data());
   result.RemoveZeroes();
-  result.is_negative = lhs < 0;
+  result.is_negative = lhs.is_negative_ != rhs.is_negative_;
   return result;
 }
-int BigInteger::CompareAbsoluteValues(const BigInteger& lhs,
-                                      const BigInteger& rhs) {
-  if (lhs.NumberOfDigits() != rhs.NumberOfDigits()) {
-    return lhs.NumberOfDigits() < rhs.NumberOfDigits() ? -1 : 1;
+template<typename Traits>
+std::pair<typename BasicBigIntegerView<Traits>::Integer,
+          typename BasicBigIntegerView<Traits>::Integer>
+BasicBigIntegerView<Traits>::Divide(BasicBigIntegerView dividend,
+                                    BasicBigIntegerView divisor,
+                                    bool needs_remainder,
+                                    std::pmr::memory_resource* resource) {
+  if (divisor.Sign() == 0) {
+    throw DivisionByZeroError();
   }
-  for (ssize_t i{lhs.NumberOfDigits() - 1}; i >= 0; i--) {
-    if (lhs.DigitAt(i) != rhs.DigitAt(i)) {
-      return lhs.DigitAt(i) < rhs.DigitAt(i) ? -1 : 1;
+  std::pair<Integer, Integer> result{Integer(0, resource),
+                                     Integer(0, resource)};
+  auto& [quotient, remainder]{result};
+  size_t lhs_size{dividend.limbs_.size()};
+  size_t rhs_size{divisor.limbs_.size()};
+  if (Kernels<Traits>::Compare(dividend.limbs_.data(), lhs_size,
+                               divisor.limbs_.data(), rhs_size) < 0) {
+    if (needs_remainder) {
+      remainder.digits_.assign(dividend.limbs_.begin(), dividend.limbs_.end());
+      remainder.is_negative = dividend.is_negative_;
     }
+    return result;
   }
-  return 0;
+  quotient.digits_.resize(lhs_size - rhs_size + 1);
+  if (needs_remainder) {
+    remainder.digits_.resize(rhs_size);
+  }
+  Kernels<Traits>::Divide(quotient.digits_.data(),
+                          needs_remainder ? remainder.digits_.data() : nullptr,
+                          dividend.limbs_.data(), lhs_size,
+                          divisor.limbs_.data(), rhs_size, resource);
+  quotient.RemoveZeroes();
+  quotient.is_negative = dividend.is_negative_ != divisor.is_negative_;
+  remainder.RemoveZeroes();
+  remainder.is_negative = dividend.is_negative_ && remainder.Sign() != 0;
+  return result;
 }
 
+template class BasicBigInteger<DecimalLimbs>;
+template class BasicBigInteger<BinaryLimbs>;
+template class BasicBigIntegerView<DecimalLimbs>;
+template class BasicBigIntegerView<BinaryLimbs>;
+template BasicBigInteger<DecimalLimbs>::BasicBigInteger(
+    const BasicBigInteger<BinaryLimbs>&);
+template BasicBigInteger<BinaryLimbs>::BasicBigInteger(
+    const BasicBigInteger<DecimalLimbs>&);
+
 }  // namespace big_num_arithmetic
 
-std::istream &
-operator>>(std::istream &is, big_num_arithmetic::BigInteger &big_int) {
-  std::string number;
-  is >> number;
-  int sign{1};
-  if (number.at(0) == '-') {
-    sign = -1;
-    number.erase(0, 1);
-  }
-  if (is.flags() & std::ios::hex) {
-    std::string number16 = number.substr(2, number.size() - 2);
-    big_int = big_num_arithmetic::BigInteger::FromString(number16, 16);
-  } else if (is.flags() & std::ios::oct) {
-    std::string number8 = number.substr(1, number.size() - 1);
-    big_int = big_num_arithmetic::BigInteger::FromString(number8, 8);
-  } else {
-    big_int = big_num_arithmetic::BigInteger::FromString(number, 10);
+template<typename Traits>
+std::istream& operator>>(std::istream& is,
+                         big_num_arithmetic::BasicBigInteger<Traits>& big_int) {
+  using Stream = std::istream;
+  Stream::sentry sentry(is);
+  if (!sentry) {
+    return is;
+  }
+  std::streambuf& buffer{*is.rdbuf()};
+  Stream::int_type ch{buffer.sgetc()};
+  auto is_at{[&ch](char expected) {
+    return !Stream::traits_type::eq_int_type(ch, Stream::traits_type::eof()) &&
+           Stream::traits_type::to_char_type(ch) == expected;
+  }};
+  bool is_negative{is_at('-')};
+  if (is_negative || is_at('+')) {
+    ch = buffer.snextc();
+  }
+  // Without a base flag the prefix chooses the base, as for the built-in
+  // integers.
+  int base{GetStreamBase(is)};
+  bool is_base_given{(is.flags() & std::ios_base::basefield) != 0};
+  bool has_digits{false};
+  if ((base == 16 || !is_base_given) && is_at('0')) {
+    ch = buffer.snextc();
+    if (is_at('x') || is_at('X')) {
+      ch = buffer.snextc();
+      base = 16;
+    } else {
+      has_digits = true;
+      base = is_base_given ? base : 8;
+    }
+  }
+  big_num_arithmetic::DigitParser<Traits> parser(base, big_int.Resource());
+  for (;; ch = buffer.snextc()) {
+    if (Stream::traits_type::eq_int_type(ch, Stream::traits_type::eof())) {
+      is.setstate(std::ios_base::eofbit);
+      break;
+    }
+    int digit{big_num_arithmetic::CharToDigit(
+        static_cast<char>(std::tolower(static_cast<unsigned char>(
+            Stream::traits_type::to_char_type(ch)))))};
+    if (digit == -1 || digit >= base) {
+      break;
+    }
+    parser.Push(digit);
   }
-  big_int *= sign;
+  if (!has_digits && parser.IsEmpty()) {
+    big_int = {};
+    is.setstate(std::ios_base::failbit);
+    return is;
+  }
+  big_int = big_num_arithmetic::BasicBigInteger<Traits>::ImportLimbs(
+      parser.Finish(), is_negative, big_int.Resource());
   return is;
 }
 
-std::ostream &
-operator<<(std::ostream &os, const big_num_arithmetic::BigInteger &big_int) {
-  std::string str = big_int.ToString(10);
-  if (os.flags() & std::ios::showbase) {
-    if (os.flags() & std::ios::hex) {
-      if (big_int < 0) {
-        os << '-' << std::hex << std::showbase << str;
-      } else {
-        os << std::hex << std::showbase << str;
-      }
-    } else if (os.flags() & std::ios::oct) {
-      if (big_int < 0) {
-        os << '-' << std::oct << std::showbase << str;
-      } else {
-        os << std::oct << std::showbase << str;
-      }
-    } else {
-      if (big_int < 0) {
-        os << '-' << str;
-      } else {
-        os << str;
-      }
-    }
-  } else {
-    os << str;
+template<typename Traits>
+std::ostream& operator<<(
+    std::ostream& os,
+    const big_num_arithmetic::BasicBigInteger<Traits>& big_int) {
+  std::ostream::sentry sentry(os);
+  if (!sentry) {
+    return os;
+  }
+  int base{GetStreamBase(os)};
+  std::string prefix;
+  if (big_int.Sign() < 0) {
+    prefix += '-';
+  } else if ((os.flags() & std::ios_base::showpos) && base == 10) {
+    // As for the built-in integers, which are unsigned in the other bases.
+    prefix += '+';
   }
+  // Internal padding follows "0x" but precedes the leading zero of octal.
+  std::string leading_zero;
+  if (IsShowbaseSet(os) && big_int.Sign() != 0) {
+    (base == 8 ? leading_zero : prefix) +=
+        big_num_arithmetic::GetBasePrefix(base);
+  }
+  big_num_arithmetic::DigitFormatter<Traits> digits(big_int.Magnitude(), base,
+                                                    big_int.Resource());
+  auto width{static_cast<size_t>(std::max<std::streamsize>(os.width(), 0))};
+  size_t padding{width - std::min(width, prefix.size() + leading_zero.size() +
+                                             digits.Size())};
+  auto adjustment{os.flags() & std::ios_base::adjustfield};
+
+  big_num_arithmetic::StreambufOutput output(
+      *os.rdbuf(), (os.flags() & std::ios_base::uppercase) != 0);
+  if (adjustment != std::ios_base::left &&
+      adjustment != std::ios_base::internal) {
+    output.PutFill(os.fill(), padding);
+  }
+  output.Put(prefix);
+  if (adjustment == std::ios_base::internal) {
+    output.PutFill(os.fill(), padding);
+  }
+  output.Put(leading_zero);
+  digits.WriteTo(output);
+  if (adjustment == std::ios_base::left) {
+    output.PutFill(os.fill(), padding);
+  }
+  if (!output.Flush()) {
+    os.setstate(std::ios_base::badbit);
+  }
+  os.width(0);
   return os;
 }
+
+template std::istream& operator>>(std::istream&,
+                                  big_num_arithmetic::BigInteger&);
+template std::istream& operator>>(std::istream&,
+                                  big_num_arithmetic::BinaryBigInteger&);
+template std::ostream& operator<<(std::ostream&,
+                                  const big_num_arithmetic::BigInteger&);
+template std::ostream& operator<<(
+    std::ostream&, const big_num_arithmetic::BinaryBigInteger&);
@@ -1,16 +1,95 @@
 #ifndef BIG_INTEGER_H_
 #define BIG_INTEGER_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory_resource>
+#include <span>
 #include <string>
-#include <vector>
+#include <utility>
+
+#include "big_integer_storage.h"
 
 namespace big_num_arithmetic {
 
-class BigInteger {
+// Limb representations. Both keep 32-bit limbs with 64-bit intermediates, the
+// decimal one stores nine decimal digits per limb, which makes decimal
+// conversions linear, the binary one uses the full word, which makes
+// conversions to and from power-of-two bases linear.
+struct DecimalLimbs {
+  using Limb = uint32_t;
+  using WideLimb = uint64_t;
+  static constexpr WideLimb kBase{1'000'000'000};
+};
+struct BinaryLimbs {
+  using Limb = uint32_t;
+  using WideLimb = uint64_t;
+  static constexpr WideLimb kBase{WideLimb{1} << 32};
+};
+
+template<typename Traits>
+class BasicModContext;
+template<typename Traits>
+class BasicBigIntegerView;
+template<typename Traits>
+class BasicBigIntegerAccumulator;
+
+// The limbs live in a std::pmr::memory_resource, the default one unless
+// given otherwise. Copies and the results of the operators allocate from
+// the resource of their (left) operand, assignment keeps the resource of the
+// target. The resource need not be thread-safe, work forked into the thread
+// pool allocates from std::pmr::new_delete_resource().
+template<typename Traits>
+class BasicBigInteger {
  public:
-  BigInteger() = default;
-  explicit BigInteger(int64_t);
-  static BigInteger FromString(const std::string&, int);
+  using Limb = typename Traits::Limb;
+
+  BasicBigInteger() = default;
+  // BasicBigInteger(0, resource) is a zero that allocates from the
+  // resource once it grows. A lone resource parameter would make
+  // BasicBigInteger(0) ambiguous.
+  explicit BasicBigInteger(
+      int64_t,
+      std::pmr::memory_resource* = std::pmr::get_default_resource());
+  // Copies the value into another resource.
+  BasicBigInteger(const BasicBigInteger& other,
+                  std::pmr::memory_resource* resource)
+      : digits_(other.digits_, resource), is_negative(other.is_negative) {}
+  // Converts between the limb representations.
+  template<typename OtherTraits>
+  explicit BasicBigInteger(const BasicBigInteger<OtherTraits>&);
+  explicit BasicBigInteger(BasicBigIntegerView<Traits>);
+  static BasicBigInteger FromString(
+      const std::string&, int,
+      std::pmr::memory_resource* = std::pmr::get_default_resource());
+
+  [[nodiscard]] std::pmr::memory_resource* Resource() const {
+    return this->digits_.get_allocator().resource();
+  }
+
+  // The magnitude as little-endian limbs without leading zeros.
+  [[nodiscard]] std::span<const Limb> Magnitude() const {
+    return {this->digits_.data(), this->digits_.size()};
+  }
+  // Copies the magnitude into the output and returns the number of limbs.
+  // Throws std::length_error if the output is too short.
+  size_t ExportLimbs(std::span<Limb> output) const;
+  // Throws std::logic_error if a limb is not below Traits::kBase.
+  static BasicBigInteger ImportLimbs(
+      std::span<const Limb> limbs, bool is_negative = false,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  // The binary format is a 32-bit flags word, with bit 0 set for negative
+  // values and bit 1 for binary limbs, the 32-bit limb count and the limbs
+  // of the magnitude, all little-endian.
+  [[nodiscard]] size_t SerializedSize() const;
+  // Returns the number of bytes written. Throws std::length_error if the
+  // output is too short.
+  size_t Serialize(std::span<std::byte> output) const;
+  // Reads values written with either limb type. Throws std::runtime_error
+  // if the input is malformed.
+  static BasicBigInteger Deserialize(std::span<const std::byte> input);
 
   [[nodiscard]] std::string ToString(int base,
                                      bool should_show_base = false) const;
@@ -20,12 +99,12 @@ class BigInteger {
   inline void Negate() { this->is_negative = !this->is_negative; }
   inline void Abs() { this->is_negative = false; }
 
-  bool operator==(const BigInteger&) const;
-  bool operator!=(const BigInteger&) const;
-  bool operator<(const BigInteger&) const;
-  bool operator>(const BigInteger&) const;
-  bool operator<=(const BigInteger&) const;
-  bool operator>=(const BigInteger&) const;
+  bool operator==(const BasicBigInteger&) const;
+  bool operator!=(const BasicBigInteger&) const;
+  bool operator<(const BasicBigInteger&) const;
+  bool operator>(const BasicBigInteger&) const;
+  bool operator<=(const BasicBigInteger&) const;
+  bool operator>=(const BasicBigInteger&) const;
 
   bool operator==(int64_t) const;
   bool operator!=(int64_t) const;
@@ -34,81 +113,141 @@ class BigInteger {
   bool operator<=(int64_t) const;
   bool operator>=(int64_t) const;
 
-  friend bool operator==(int64_t, const BigInteger&);
-  friend bool operator!=(int64_t, const BigInteger&);
-  friend bool operator<(int64_t, const BigInteger&);
-  friend bool operator>(int64_t, const BigInteger&);
-  friend bool operator<=(int64_t, const BigInteger&);
-  friend bool operator>=(int64_t, const BigInteger&);
-
-  BigInteger& operator+=(const BigInteger&);
-  BigInteger& operator-=(const BigInteger&);
-  BigInteger& operator*=(const BigInteger&);
-  BigInteger& operator/=(const BigInteger&);
-
-  BigInteger& operator+=(int64_t);
-  BigInteger& operator-=(int64_t);
-  BigInteger& operator*=(int64_t);
-  BigInteger& operator/=(int64_t);
-
-  BigInteger operator+(const BigInteger&) const;
-  BigInteger operator-(const BigInteger&) const;
-  BigInteger operator*(const BigInteger&) const;
-  BigInteger operator/(const BigInteger&) const;
-
-  BigInteger operator+(int64_t) const;
-  BigInteger operator-(int64_t) const;
-  BigInteger operator*(int64_t) const;
-  BigInteger operator/(int64_t) const;
-
-  friend BigInteger operator+(int64_t, const BigInteger&);
-  friend BigInteger operator-(int64_t, const BigInteger&);
-  friend BigInteger operator*(int64_t, const BigInteger&);
-  friend BigInteger operator/(int64_t, const BigInteger&);
+  friend bool operator==(int64_t lhs, const BasicBigInteger& rhs) {
+    return rhs == lhs;
+  }
+  friend bool operator!=(int64_t lhs, const BasicBigInteger& rhs) {
+    return rhs != lhs;
+  }
+  friend bool operator<(int64_t lhs, const BasicBigInteger& rhs) {
+    return rhs > lhs;
+  }
+  friend bool operator>(int64_t lhs, const BasicBigInteger& rhs) {
+    return rhs < lhs;
+  }
+  friend bool operator<=(int64_t lhs, const BasicBigInteger& rhs) {
+    return rhs >= lhs;
+  }
+  friend bool operator>=(int64_t lhs, const BasicBigInteger& rhs) {
+    return rhs <= lhs;
+  }
+
+  BasicBigInteger& operator+=(const BasicBigInteger&);
+  BasicBigInteger& operator-=(const BasicBigInteger&);
+  BasicBigInteger& operator*=(const BasicBigInteger&);
+  BasicBigInteger& operator/=(const BasicBigInteger&);
+
+  BasicBigInteger& operator+=(BasicBigIntegerView<Traits>);
+  BasicBigInteger& operator-=(BasicBigIntegerView<Traits>);
+
+  BasicBigInteger& operator+=(int64_t);
+  BasicBigInteger& operator-=(int64_t);
+  BasicBigInteger& operator*=(int64_t);
+  BasicBigInteger& operator/=(int64_t);
+
+  // The rvalue overloads reuse the limb buffer of the temporary operand.
+  BasicBigInteger operator+(const BasicBigInteger&) const&;
+  BasicBigInteger operator+(const BasicBigInteger&) &&;
+  BasicBigInteger operator+(BasicBigInteger&&) const&;
+  BasicBigInteger operator+(BasicBigInteger&&) &&;
+  BasicBigInteger operator-(const BasicBigInteger&) const&;
+  BasicBigInteger operator-(const BasicBigInteger&) &&;
+  BasicBigInteger operator-(BasicBigInteger&&) const&;
+  BasicBigInteger operator-(BasicBigInteger&&) &&;
+  BasicBigInteger operator*(const BasicBigInteger&) const;
+  BasicBigInteger operator/(const BasicBigInteger&) const;
+  // The remainder takes the sign of the dividend, as for the built-in types.
+  BasicBigInteger operator%(const BasicBigInteger&) const;
+  BasicBigInteger& operator%=(const BasicBigInteger&);
+  // Truncated quotient and remainder from a single division.
+  static std::pair<BasicBigInteger, BasicBigInteger> DivMod(
+      const BasicBigInteger& dividend, const BasicBigInteger& divisor);
+  static BasicBigInteger Pow(const BasicBigInteger& base, uint64_t exponent);
+  // Returns base^exponent mod modulus in [0, modulus). To raise many values
+  // modulo the same number, keep a BasicModContext instead.
+  static BasicBigInteger PowMod(const BasicBigInteger& base,
+                                const BasicBigInteger& exponent,
+                                const BasicBigInteger& modulus);
+
+  BasicBigInteger operator+(int64_t) const;
+  BasicBigInteger operator-(int64_t) const;
+  BasicBigInteger operator*(int64_t) const;
+  BasicBigInteger operator/(int64_t) const;
+
+  friend BasicBigInteger operator+(int64_t lhs, const BasicBigInteger& rhs) {
+    return BasicBigInteger(lhs) + rhs;
+  }
+  friend BasicBigInteger operator-(int64_t lhs, const BasicBigInteger& rhs) {
+    return BasicBigInteger(lhs) - rhs;
+  }
+  friend BasicBigInteger operator*(int64_t lhs, const BasicBigInteger& rhs) {
+    return BasicBigInteger(lhs) * rhs;
+  }
+  friend BasicBigInteger operator/(int64_t lhs, const BasicBigInteger& rhs) {
+    return BasicBigInteger(lhs) / rhs;
+  }
 
+  // Returns the residue in [0, rhs).
   uint32_t operator%(uint32_t) const;
 
-  const BigInteger operator++(int);
-  BigInteger& operator++();
-  const BigInteger operator--(int);
-  BigInteger& operator--();
+  const BasicBigInteger operator++(int);
+  BasicBigInteger& operator++();
+  const BasicBigInteger operator--(int);
+  BasicBigInteger& operator--();
 
-  BigInteger operator-() const;
-  BigInteger operator+() const { return *this; }
+  BasicBigInteger operator-() const&;
+  BasicBigInteger operator-() &&;
+  BasicBigInteger operator+() const { return *this; }
 
   explicit operator int64_t() const;
 
-  static int64_t internal_base;
+  static constexpr int64_t internal_base{Traits::kBase};
 
  private:
-  std::vector<int64_t> digits_;
+  template<typename> friend class BasicBigInteger;
+  template<typename> friend class BasicModContext;
+  template<typename> friend class BasicBigIntegerView;
+  template<typename> friend class BasicBigIntegerAccumulator;
+  using View = BasicBigIntegerView<Traits>;
+
+  LimbStorage<Limb> digits_;
   bool is_negative{false};
 
-  [[nodiscard]] int64_t DigitAt(size_t pos) const;
-  [[nodiscard]] int64_t& DigitAt(size_t pos);
-  [[nodiscard]] int64_t SignedDigitAt(size_t pos) const;
   [[nodiscard]] ssize_t NumberOfDigits() const;
-  [[nodiscard]] int64_t LeadingDigit() const;
 
   void RemoveZeroes();
-  inline void SetSign(int64_t value);
-  void InsertLeastSignificantDigit(int64_t digit, int64_t quantity);
-  void InsertLeastSignificantDigit(int64_t digit);
-  inline void PushLeadingDigit(int64_t digit);
-  inline void PushDigitToEnd(int64_t digit);
-  void ReverseDigitsAndNormalize();
-
-  static inline int64_t RemainderByBase(int64_t number);
-  friend BigInteger MultiplyByShort(const BigInteger&, int64_t);
-  static int CompareAbsoluteValues(const BigInteger& lhs,
-                                   const BigInteger& rhs);
+  inline void PushLeadingDigit(Limb digit);
+
+  // Enough limbs for the magnitude of any int64_t.
+  static constexpr size_t kInt64Limbs = 3;
+  [[nodiscard]] static bool FitsIntoLimb(int64_t value);
+  // Writes the magnitude of the value into limbs and returns their number.
+  static size_t ToLimbs(int64_t value, Limb* limbs);
+  [[nodiscard]] int CompareWith(int64_t value) const;
+  // *this += rhs in place, where rhs is given by its magnitude and sign.
+  void AddSigned(const Limb* rhs, size_t rhs_size, bool rhs_is_negative);
+  void MultiplyByLimb(Limb multiplier);
+  // Returns the remainder of the magnitude.
+  Limb DivideByLimb(Limb divisor);
+  static int CompareAbsoluteValues(const BasicBigInteger& lhs,
+                                   const BasicBigInteger& rhs);
 };
 
+using BigInteger = BasicBigInteger<DecimalLimbs>;
+using BinaryBigInteger = BasicBigInteger<BinaryLimbs>;
+
+extern template class BasicBigInteger<DecimalLimbs>;
+extern template class BasicBigInteger<BinaryLimbs>;
+
 struct DivisionByZeroError {};
 
 }  // namespace big_num_arithmetic
 
-std::ostream& operator<<(std::ostream&, const big_num_arithmetic::BigInteger&);
-std::istream& operator>>(std::istream&, big_num_arithmetic::BigInteger&);
+template<typename Traits>
+std::ostream& operator<<(std::ostream&,
+                         const big_num_arithmetic::BasicBigInteger<Traits>&);
+template<typename Traits>
+std::istream& operator>>(std::istream&,
+                         big_num_arithmetic::BasicBigInteger<Traits>&);
 
 #endif  // BIG_INTEGER_H_
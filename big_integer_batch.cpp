@@ -0,0 +1,89 @@
+#include "big_integer_batch.h"
+
+namespace big_num_arithmetic {
+
+template<typename Traits>
+BasicBigIntegerAccumulator<Traits>&
+BasicBigIntegerAccumulator<Traits>::operator+=(
+    BasicBigIntegerView<Traits> value) {
+  this->Add(value.Sign() < 0 ? this->negative_ : this->positive_,
+            value.Magnitude());
+  return *this;
+}
+template<typename Traits>
+BasicBigIntegerAccumulator<Traits>&
+BasicBigIntegerAccumulator<Traits>::operator-=(
+    BasicBigIntegerView<Traits> value) {
+  this->Add(value.Sign() < 0 ? this->positive_ : this->negative_,
+            value.Magnitude());
+  return *this;
+}
+
+template<typename Traits>
+typename BasicBigIntegerAccumulator<Traits>::Integer
+BasicBigIntegerAccumulator<Traits>::Total() const {
+  Integer result{ToInteger(this->positive_)};
+  result -= ToInteger(this->negative_);
+  return result;
+}
+template<typename Traits>
+void BasicBigIntegerAccumulator<Traits>::Clear() {
+  this->positive_.clear();
+  this->negative_.clear();
+  this->terms_ = 0;
+}
+
+template<typename Traits>
+void BasicBigIntegerAccumulator<Traits>::Add(Columns& columns,
+                                             std::span<const Limb> limbs) {
+  if (this->terms_ == kMaxTerms) {
+    PropagateCarries(this->positive_);
+    PropagateCarries(this->negative_);
+    this->terms_ = 0;
+  }
+  ++this->terms_;
+  if (columns.size() < limbs.size()) {
+    columns.resize(limbs.size(), 0);
+  }
+  WideLimb* data{columns.data()};
+  for (size_t i{0}; i < limbs.size(); ++i) {
+    data[i] += limbs[i];
+  }
+}
+
+template<typename Traits>
+void BasicBigIntegerAccumulator<Traits>::PropagateCarries(Columns& columns) {
+  WideLimb carry{0};
+  for (WideLimb& column : columns) {
+    column += carry;
+    carry = column / Traits::kBase;
+    column %= Traits::kBase;
+  }
+  for (; carry != 0; carry /= Traits::kBase) {
+    columns.push_back(carry % Traits::kBase);
+  }
+}
+
+template<typename Traits>
+typename BasicBigIntegerAccumulator<Traits>::Integer
+BasicBigIntegerAccumulator<Traits>::ToInteger(const Columns& columns) {
+  Integer result(0, columns.get_allocator().resource());
+  result.digits_.resize(columns.size() + 2);
+  WideLimb carry{0};
+  size_t size{0};
+  for (WideLimb column : columns) {
+    column += carry;
+    carry = column / Traits::kBase;
+    result.digits_[size++] = static_cast<Limb>(column % Traits::kBase);
+  }
+  for (; carry != 0; carry /= Traits::kBase) {
+    result.digits_[size++] = static_cast<Limb>(carry % Traits::kBase);
+  }
+  result.RemoveZeroes();
+  return result;
+}
+
+template class BasicBigIntegerAccumulator<DecimalLimbs>;
+template class BasicBigIntegerAccumulator<BinaryLimbs>;
+
+}  // namespace big_num_arithmetic
@@ -0,0 +1,113 @@
+#ifndef BIG_INTEGER_BATCH_H_
+#define BIG_INTEGER_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+#include "algorithms.h"
+#include "big_integer.h"
+#include "big_integer_view.h"
+
+namespace big_num_arithmetic {
+
+// Sum of many values. Their limbs are added into 64-bit columns without
+// propagating carries, positive and negative values apart, and the carries
+// are resolved only when the columns could overflow and once for Total, so
+// adding a value costs one pass over its limbs that the compiler
+// vectorizes.
+template<typename Traits>
+class BasicBigIntegerAccumulator {
+ public:
+  using Integer = BasicBigInteger<Traits>;
+
+  BasicBigIntegerAccumulator() = default;
+  explicit BasicBigIntegerAccumulator(std::pmr::memory_resource* resource)
+      : positive_(resource), negative_(resource) {}
+
+  BasicBigIntegerAccumulator& operator+=(BasicBigIntegerView<Traits> value);
+  BasicBigIntegerAccumulator& operator-=(BasicBigIntegerView<Traits> value);
+
+  // The sum of the values so far, in the resource of the accumulator.
+  [[nodiscard]] Integer Total() const;
+  void Clear();
+
+ private:
+  using Limb = typename Traits::Limb;
+  using WideLimb = typename Traits::WideLimb;
+  using Columns = std::pmr::vector<WideLimb>;
+
+  // Every column stays below kBase * (kMaxTerms + 1) and so far from
+  // overflowing while carries are pending.
+  static constexpr uint64_t kMaxTerms = UINT64_MAX / Traits::kBase / 2;
+
+  void Add(Columns& columns, std::span<const Limb> limbs);
+  // Brings every column below kBase.
+  static void PropagateCarries(Columns& columns);
+  // The value of the columns, which need not have their carries resolved.
+  static Integer ToInteger(const Columns& columns);
+
+  Columns positive_;
+  Columns negative_;
+  // Values added since the carries were last resolved.
+  uint64_t terms_{0};
+};
+
+using BigIntegerAccumulator = BasicBigIntegerAccumulator<DecimalLimbs>;
+using BinaryBigIntegerAccumulator = BasicBigIntegerAccumulator<BinaryLimbs>;
+
+extern template class BasicBigIntegerAccumulator<DecimalLimbs>;
+extern template class BasicBigIntegerAccumulator<BinaryLimbs>;
+
+// Product of the values in [begin, end), one for an empty range. The
+// partial products are merged like the digits of a binary counter, each
+// with a neighbour at least as long, so the product tree stays balanced for
+// any order of the factors and the fast multiplications see operands of
+// similar length. A single pass over the range suffices.
+template<typename Iterator>
+typename std::iterator_traits<Iterator>::value_type ProductOf(Iterator begin,
+                                                              Iterator end) {
+  using Integer = typename std::iterator_traits<Iterator>::value_type;
+  std::vector<Integer> partials;
+  for (Iterator iter{begin}; iter != end; ++iter) {
+    partials.push_back(*iter);
+    while (partials.size() >= 2 &&
+           partials[partials.size() - 2].Magnitude().size() <=
+               partials.back().Magnitude().size()) {
+      Integer top{std::move(partials.back())};
+      partials.pop_back();
+      partials.back() *= top;
+    }
+  }
+  if (partials.empty()) {
+    return Integer(1);
+  }
+  Integer result{std::move(partials.back())};
+  for (size_t i{partials.size() - 1}; i > 0; --i) {
+    result *= partials[i - 1];
+  }
+  return result;
+}
+template<typename Range>
+auto ProductOf(const Range& range) {
+  return ProductOf(std::begin(range), std::end(range));
+}
+
+}  // namespace big_num_arithmetic
+
+// Accumulate, with or without an execution policy, sums BigIntegers in
+// the batch accumulator.
+template<typename Traits>
+struct Accumulation<big_num_arithmetic::BasicBigInteger<Traits>> {
+  using Partial = big_num_arithmetic::BasicBigIntegerAccumulator<Traits>;
+
+  static big_num_arithmetic::BasicBigInteger<Traits> Total(
+      const Partial& partial) {
+    return partial.Total();
+  }
+};
+
+#endif  // BIG_INTEGER_BATCH_H_
@@ -0,0 +1,675 @@
+#include "big_integer_kernels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "big_integer_ntt.h"
+#include "big_integer_simd.h"
+#include "instrumentation.h"
+#include "thread_pool.h"
+
+namespace big_num_arithmetic::kernels {
+
+namespace {
+
+template<typename Traits>
+constexpr bool kIsBinary{std::is_same_v<Traits, BinaryLimbs>};
+
+bool ShouldMultiplyInParallel(size_t size) {
+  return size >= kParallelMultiplyThreshold &&
+         concurrency::ThreadPool::Default().IsParallel();
+}
+
+}  // namespace
+
+template<typename Traits>
+void LimbKernels<Traits>::AddAt(Limb* result, size_t result_size,
+                                size_t offset, const Limb* span, size_t size) {
+  size = Normalized(span, size);
+  assert(offset + size <= result_size);
+  [[maybe_unused]] Limb carry{Add(result + offset, result + offset,
+                                  result_size - offset, span, size)};
+  assert(carry == 0);
+}
+
+template<typename Traits>
+void LimbKernels<Traits>::MultiplySchoolbook(Limb* result, const Limb* lhs,
+                                             size_t lhs_size, const Limb* rhs,
+                                             size_t rhs_size) {
+  std::fill(result, result + lhs_size + rhs_size, 0);
+  for (size_t i{0}; i < rhs_size; ++i) {
+    result[i + lhs_size] =
+        AddMultipliedByShort(result + i, lhs, lhs_size, rhs[i]);
+  }
+}
+
+// Computes the off-diagonal products once, doubles them and then adds the
+// squares of the limbs.
+template<typename Traits>
+void LimbKernels<Traits>::SquareSchoolbook(Limb* result, const Limb* span,
+                                           size_t size) {
+  std::fill(result, result + 2 * size, 0);
+  for (size_t i{0}; i + 1 < size; ++i) {
+    result[i + size] = AddMultipliedByShort(result + 2 * i + 1, span + i + 1,
+                                            size - i - 1, span[i]);
+  }
+  Add(result, result, 2 * size, result, 2 * size);
+  WideLimb carry{0};
+  for (size_t i{0}; i < size; ++i) {
+    WideLimb square{WideLimb{span[i]} * span[i]};
+    WideLimb digit{result[2 * i] + square % kBase + carry};
+    result[2 * i] = static_cast<Limb>(digit % kBase);
+    digit = result[2 * i + 1] + square / kBase + digit / kBase;
+    result[2 * i + 1] = static_cast<Limb>(digit % kBase);
+    carry = digit / kBase;
+  }
+}
+
+// Splits lhs into rhs_size-long chunks, so that every partial product is
+// balanced.
+template<typename Traits>
+void LimbKernels<Traits>::MultiplyUnbalanced(Limb* result, const Limb* lhs,
+                                             size_t lhs_size, const Limb* rhs,
+                                             size_t rhs_size, Limb* scratch) {
+  Multiply(result, lhs, rhs_size, rhs, rhs_size, scratch);
+  std::fill(result + 2 * rhs_size, result + lhs_size + rhs_size, 0);
+  Limb* product{scratch};
+  for (size_t offset{rhs_size}; offset < lhs_size; offset += rhs_size) {
+    size_t chunk_size{std::min(rhs_size, lhs_size - offset)};
+    Multiply(product, lhs + offset, chunk_size, rhs, rhs_size,
+             product + chunk_size + rhs_size);
+    AddAt(result, lhs_size + rhs_size, offset, product, chunk_size + rhs_size);
+  }
+}
+
+// Requires lhs_size >= rhs_size > (lhs_size + 1) / 2.
+template<typename Traits>
+void LimbKernels<Traits>::MultiplyKaratsuba(Limb* result, const Limb* lhs,
+                                            size_t lhs_size, const Limb* rhs,
+                                            size_t rhs_size, Limb* scratch) {
+  size_t split{(lhs_size + 1) / 2};
+  size_t lhs_high_size{lhs_size - split};
+  size_t rhs_high_size{rhs_size - split};
+  Limb* lhs_sum{scratch};
+  Limb* rhs_sum{lhs_sum + split + 1};
+  Limb* middle{rhs_sum + split + 1};
+  size_t middle_size{2 * split + 2};
+  auto add_halves{[&] {
+    lhs_sum[split] = Add(lhs_sum, lhs, split, lhs + split, lhs_high_size);
+    if (lhs == rhs && lhs_size == rhs_size) {
+      rhs_sum = lhs_sum;
+    } else {
+      rhs_sum[split] = Add(rhs_sum, rhs, split, rhs + split, rhs_high_size);
+    }
+  }};
+
+  if (ShouldMultiplyInParallel(rhs_size)) {
+    add_halves();
+    concurrency::ThreadPool::Default().Invoke(
+        [&] { MultiplyWithScratch(result, lhs, split, rhs, split); },
+        [&] {
+          MultiplyWithScratch(result + 2 * split, lhs + split, lhs_high_size,
+                              rhs + split, rhs_high_size);
+        },
+        [&] {
+          MultiplyWithScratch(middle, lhs_sum, split + 1, rhs_sum, split + 1);
+        });
+  } else {
+    Multiply(result, lhs, split, rhs, split, scratch);
+    Multiply(result + 2 * split, lhs + split, lhs_high_size,
+             rhs + split, rhs_high_size, scratch);
+    add_halves();
+    Multiply(middle, lhs_sum, split + 1, rhs_sum, split + 1,
+             middle + middle_size);
+  }
+  Subtract(middle, middle, middle_size, result, 2 * split);
+  Subtract(middle, middle, middle_size,
+           result + 2 * split, lhs_high_size + rhs_high_size);
+  AddAt(result, lhs_size + rhs_size, split, middle, middle_size);
+}
+
+// Evaluates x0 + x1 * t + x2 * t^2 at t = 1, -1 and 2. Every output has
+// part + 1 limbs, the value at -1 is stored as an absolute value and the
+// function returns whether it is negative.
+template<typename Traits>
+bool LimbKernels<Traits>::EvaluateToom3(const Limb* x, size_t part,
+                                        size_t top_size, Limb* at_one,
+                                        Limb* at_minus_one, Limb* at_two) {
+  const Limb* middle{x + part};
+  const Limb* top{x + 2 * part};
+  at_minus_one[part] = Add(at_minus_one, x, part, top, top_size);
+  Add(at_one, at_minus_one, part + 1, middle, part);
+  bool is_negative{Compare(at_minus_one, part + 1, middle, part) < 0};
+  if (is_negative) {
+    Subtract(at_minus_one, middle, part, at_minus_one, part);
+  } else {
+    Subtract(at_minus_one, at_minus_one, part + 1, middle, part);
+  }
+  WideLimb carry{0};
+  for (size_t i{0}; i < part; ++i) {
+    WideLimb value{x[i] + 2 * WideLimb{middle[i]} + carry};
+    if (i < top_size) {
+      value += 4 * WideLimb{top[i]};
+    }
+    at_two[i] = static_cast<Limb>(value % kBase);
+    carry = value / kBase;
+  }
+  at_two[part] = static_cast<Limb>(carry);
+  return is_negative;
+}
+
+// Requires lhs_size >= rhs_size > 2 * ((lhs_size + 2) / 3). Interpolation
+// follows Bodrato's sequence, which keeps every intermediate value
+// non-negative, so only the value at -1 needs a sign.
+template<typename Traits>
+void LimbKernels<Traits>::MultiplyToom3(Limb* result, const Limb* lhs,
+                                        size_t lhs_size, const Limb* rhs,
+                                        size_t rhs_size, Limb* scratch) {
+  size_t part{(lhs_size + 2) / 3};
+  size_t lhs_top_size{lhs_size - 2 * part};
+  size_t rhs_top_size{rhs_size - 2 * part};
+  size_t evaluation_size{part + 1};
+  size_t product_size{2 * evaluation_size};
+
+  Limb* lhs_at_one{scratch};
+  Limb* lhs_at_minus_one{lhs_at_one + evaluation_size};
+  Limb* lhs_at_two{lhs_at_minus_one + evaluation_size};
+  Limb* rhs_at_one{lhs_at_two + evaluation_size};
+  Limb* rhs_at_minus_one{rhs_at_one + evaluation_size};
+  Limb* rhs_at_two{rhs_at_minus_one + evaluation_size};
+  Limb* at_one{rhs_at_two + evaluation_size};
+  Limb* at_minus_one{at_one + product_size};
+  Limb* at_two{at_minus_one + product_size};
+  Limb* rest{at_two + product_size};
+
+  bool is_negative{false};
+  if (lhs == rhs && lhs_size == rhs_size) {
+    EvaluateToom3(lhs, part, lhs_top_size,
+                  lhs_at_one, lhs_at_minus_one, lhs_at_two);
+    rhs_at_one = lhs_at_one;
+    rhs_at_minus_one = lhs_at_minus_one;
+    rhs_at_two = lhs_at_two;
+  } else {
+    is_negative =
+        EvaluateToom3(lhs, part, lhs_top_size,
+                      lhs_at_one, lhs_at_minus_one, lhs_at_two) !=
+        EvaluateToom3(rhs, part, rhs_top_size,
+                      rhs_at_one, rhs_at_minus_one, rhs_at_two);
+  }
+  const Limb* at_zero{result};
+  size_t at_zero_size{2 * part};
+  const Limb* at_infinity{result + 4 * part};
+  size_t at_infinity_size{lhs_top_size + rhs_top_size};
+  std::fill(result + 2 * part, result + 4 * part, 0);
+  if (ShouldMultiplyInParallel(rhs_size)) {
+    concurrency::ThreadPool::Default().Invoke(
+        [&] {
+          MultiplyWithScratch(at_one, lhs_at_one, evaluation_size,
+                              rhs_at_one, evaluation_size);
+        },
+        [&] {
+          MultiplyWithScratch(at_minus_one, lhs_at_minus_one, evaluation_size,
+                              rhs_at_minus_one, evaluation_size);
+        },
+        [&] {
+          MultiplyWithScratch(at_two, lhs_at_two, evaluation_size,
+                              rhs_at_two, evaluation_size);
+        },
+        [&] { MultiplyWithScratch(result, lhs, part, rhs, part); },
+        [&] {
+          MultiplyWithScratch(result + 4 * part, lhs + 2 * part, lhs_top_size,
+                              rhs + 2 * part, rhs_top_size);
+        });
+  } else {
+    Multiply(at_one, lhs_at_one, evaluation_size,
+             rhs_at_one, evaluation_size, rest);
+    Multiply(at_minus_one, lhs_at_minus_one, evaluation_size,
+             rhs_at_minus_one, evaluation_size, rest);
+    Multiply(at_two, lhs_at_two, evaluation_size,
+             rhs_at_two, evaluation_size, rest);
+    Multiply(result, lhs, part, rhs, part, rest);
+    Multiply(result + 4 * part, lhs + 2 * part, lhs_top_size,
+             rhs + 2 * part, rhs_top_size, rest);
+  }
+
+  if (is_negative) {
+    Add(at_two, at_two, product_size, at_minus_one, product_size);
+    Add(at_minus_one, at_one, product_size, at_minus_one, product_size);
+  } else {
+    Subtract(at_two, at_two, product_size, at_minus_one, product_size);
+    Subtract(at_minus_one, at_one, product_size, at_minus_one, product_size);
+  }
+  DivideByShort(at_two, product_size, 3);
+  DivideByShort(at_minus_one, product_size, 2);
+  Subtract(at_one, at_one, product_size, at_zero, at_zero_size);
+  Subtract(at_two, at_two, product_size, at_one, product_size);
+  DivideByShort(at_two, product_size, 2);
+  Subtract(at_one, at_one, product_size, at_minus_one, product_size);
+  Subtract(at_one, at_one, product_size, at_infinity, at_infinity_size);
+  Subtract(at_two, at_two, product_size, at_infinity, at_infinity_size);
+  Subtract(at_two, at_two, product_size, at_infinity, at_infinity_size);
+  Subtract(at_minus_one, at_minus_one, product_size, at_two, product_size);
+
+  size_t result_size{lhs_size + rhs_size};
+  AddAt(result, result_size, part, at_minus_one, product_size);
+  AddAt(result, result_size, 2 * part, at_one, product_size);
+  AddAt(result, result_size, 3 * part, at_two, product_size);
+}
+
+// Knuth's algorithm D. The divisor must have at least two limbs, the
+// dividend is copied and both are multiplied by a factor that brings the
+// leading divisor limb to at least kBase / 2, which makes every quotient
+// limb estimate at most two units too large.
+template<typename Traits>
+void LimbKernels<Traits>::DivideKnuth(Limb* quotient, Limb* remainder,
+                                      const Limb* dividend,
+                                      size_t dividend_size,
+                                      const Limb* divisor,
+                                      size_t divisor_size,
+                                      std::pmr::memory_resource* resource) {
+  size_t quotient_size{dividend_size - divisor_size + 1};
+  std::pmr::vector<Limb> buffer(dividend_size + 1 + divisor_size, resource);
+  Limb* normalized_dividend{buffer.data()};
+  Limb* normalized_divisor{normalized_dividend + dividend_size + 1};
+  auto factor{
+      static_cast<Limb>(kBase / (WideLimb{divisor[divisor_size - 1]} + 1))};
+  normalized_dividend[dividend_size] =
+      MultiplyByShort(normalized_dividend, dividend, dividend_size, factor);
+  MultiplyByShort(normalized_divisor, divisor, divisor_size, factor);
+
+  WideLimb leading{normalized_divisor[divisor_size - 1]};
+  WideLimb next{normalized_divisor[divisor_size - 2]};
+  for (size_t j{quotient_size}; j > 0; --j) {
+    Limb* window{normalized_dividend + j - 1};
+    WideLimb top{window[divisor_size] * kBase + window[divisor_size - 1]};
+    WideLimb estimate{top / leading};
+    WideLimb estimate_remainder{top % leading};
+    while (estimate >= kBase ||
+           estimate * next >
+               estimate_remainder * kBase + window[divisor_size - 2]) {
+      --estimate;
+      estimate_remainder += leading;
+      if (estimate_remainder >= kBase) {
+        break;
+      }
+    }
+    WideLimb borrow{SubtractMultipliedByShort(
+        window, normalized_divisor, divisor_size,
+        static_cast<Limb>(estimate))};
+    if (borrow > window[divisor_size]) {
+      --estimate;
+      Limb carry{Add(window, window, divisor_size,
+                     normalized_divisor, divisor_size)};
+      window[divisor_size] =
+          static_cast<Limb>(window[divisor_size] + carry - borrow);
+    } else {
+      window[divisor_size] = static_cast<Limb>(window[divisor_size] - borrow);
+    }
+    quotient[j - 1] = static_cast<Limb>(estimate);
+  }
+  if (remainder) {
+    DivideByShort(normalized_dividend, divisor_size, factor);
+    std::copy(normalized_dividend, normalized_dividend + divisor_size,
+              remainder);
+  }
+}
+
+template<typename Traits>
+void LimbKernels<Traits>::MultiplyWithScratch(Limb* result, const Limb* lhs,
+                                              size_t lhs_size,
+                                              const Limb* rhs,
+                                              size_t rhs_size,
+                                              std::pmr::memory_resource*
+                                                  resource) {
+  std::pmr::vector<Limb> scratch(MultiplyScratchSize(lhs_size, rhs_size),
+                                 resource);
+  Multiply(result, lhs, lhs_size, rhs, rhs_size, scratch.data());
+}
+
+// Divides [a0, a1, a2] by [b0, b1], where every part has half limbs, the
+// quotient fits into half limbs and b1 has the leading limb of at least
+// kBase / 2.
+template<typename Traits>
+void LimbKernels<Traits>::DivideThreeByTwo(Limb* quotient, Limb* remainder,
+                                           const Limb* dividend,
+                                           const Limb* divisor, size_t half,
+                                           std::pmr::memory_resource*
+                                               resource) {
+  const Limb* divisor_high{divisor + half};
+  // partial = [a0, r1], where r1 is [a1, a2] - quotient * b1.
+  std::pmr::vector<Limb> partial(3 * half + 1, resource);
+  if (Compare(dividend + 2 * half, half, divisor_high, half) < 0) {
+    DivideTwoByOne(quotient, partial.data() + half, dividend + half,
+                   divisor_high, half, resource);
+  } else {
+    std::fill(quotient, quotient + half, static_cast<Limb>(kBase - 1));
+    Limb* high{partial.data() + half};
+    high[2 * half] = Add(high, dividend + half, 2 * half, divisor_high, half);
+    Subtract(high + half, high + half, half + 1, divisor_high, half);
+  }
+  std::copy(dividend, dividend + half, partial.begin());
+
+  std::pmr::vector<Limb> product(2 * half, resource);
+  MultiplyWithScratch(product.data(), quotient, half, divisor, half,
+                      resource);
+  while (Compare(partial.data(), partial.size(), product.data(),
+                 product.size()) < 0) {
+    const Limb one{1};
+    Subtract(quotient, quotient, half, &one, 1);
+    Add(partial.data(), partial.data(), partial.size(), divisor, 2 * half);
+  }
+  Subtract(partial.data(), partial.data(), partial.size(),
+           product.data(), product.size());
+  std::copy(partial.begin(), partial.begin() + 2 * half, remainder);
+}
+
+// Divides a 2 * size limb dividend by a size limb divisor with the leading
+// limb of at least kBase / 2, given that the quotient fits into size limbs.
+template<typename Traits>
+void LimbKernels<Traits>::DivideTwoByOne(Limb* quotient, Limb* remainder,
+                                         const Limb* dividend,
+                                         const Limb* divisor, size_t size,
+                                         std::pmr::memory_resource*
+                                             resource) {
+  if (size % 2 == 1 || size <= kBurnikelZieglerThreshold) {
+    std::pmr::vector<Limb> full_quotient(size + 1, resource);
+    DivideKnuth(full_quotient.data(), remainder, dividend, 2 * size,
+                divisor, size, resource);
+    std::copy(full_quotient.begin(), full_quotient.begin() + size, quotient);
+    return;
+  }
+  size_t half{size / 2};
+  std::pmr::vector<Limb> partial(3 * half, resource);
+  DivideThreeByTwo(quotient + half, partial.data() + half, dividend + half,
+                   divisor, half, resource);
+  std::copy(dividend, dividend + half, partial.begin());
+  DivideThreeByTwo(quotient, remainder, partial.data(), divisor, half,
+                   resource);
+}
+
+// Pads the divisor with low zero limbs up to a length that halves evenly
+// down to the threshold, normalizes it and divides the dividend block by
+// block.
+template<typename Traits>
+void LimbKernels<Traits>::DivideBurnikelZiegler(Limb* quotient,
+                                                Limb* remainder,
+                                                const Limb* dividend,
+                                                size_t dividend_size,
+                                                const Limb* divisor,
+                                                size_t divisor_size,
+                                                std::pmr::memory_resource*
+                                                    resource) {
+  size_t block_size{divisor_size};
+  size_t levels{0};
+  while (block_size > kBurnikelZieglerThreshold) {
+    block_size = (block_size + 1) / 2;
+    ++levels;
+  }
+  block_size <<= levels;
+  size_t shift{block_size - divisor_size};
+  auto factor{
+      static_cast<Limb>(kBase / (WideLimb{divisor[divisor_size - 1]} + 1))};
+
+  std::pmr::vector<Limb> normalized_divisor(block_size, resource);
+  MultiplyByShort(normalized_divisor.data() + shift, divisor, divisor_size,
+                  factor);
+  std::pmr::vector<Limb> normalized_dividend(dividend_size + shift + 1,
+                                             resource);
+  normalized_dividend[dividend_size + shift] = MultiplyByShort(
+      normalized_dividend.data() + shift, dividend, dividend_size, factor);
+  size_t blocks{std::max<size_t>(
+      2, (Normalized(normalized_dividend.data(), normalized_dividend.size()) +
+          block_size) / block_size)};
+  normalized_dividend.resize(blocks * block_size);
+
+  std::pmr::vector<Limb> full_quotient((blocks - 1) * block_size, resource);
+  std::pmr::vector<Limb> window(normalized_dividend.end() - 2 * block_size,
+                                normalized_dividend.end(), resource);
+  for (size_t i{blocks - 1}; i > 0; --i) {
+    DivideTwoByOne(full_quotient.data() + (i - 1) * block_size,
+                   window.data() + block_size, window.data(),
+                   normalized_divisor.data(), block_size, resource);
+    if (i > 1) {
+      std::copy(normalized_dividend.begin() + (i - 2) * block_size,
+                normalized_dividend.begin() + (i - 1) * block_size,
+                window.begin());
+    }
+  }
+  std::copy(full_quotient.begin(),
+            full_quotient.begin() + (dividend_size - divisor_size + 1),
+            quotient);
+  if (remainder) {
+    DivideByShort(window.data() + block_size + shift, divisor_size, factor);
+    std::copy(window.begin() + block_size + shift, window.end(), remainder);
+  }
+}
+
+template<typename Traits>
+int LimbKernels<Traits>::Compare(const Limb* lhs, size_t lhs_size,
+                                 const Limb* rhs, size_t rhs_size) {
+  lhs_size = Normalized(lhs, lhs_size);
+  rhs_size = Normalized(rhs, rhs_size);
+  if (lhs_size != rhs_size) {
+    return lhs_size < rhs_size ? -1 : 1;
+  }
+  for (size_t i{lhs_size}; i > 0; --i) {
+    if (lhs[i - 1] != rhs[i - 1]) {
+      return lhs[i - 1] < rhs[i - 1] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+template<typename Traits>
+size_t LimbKernels<Traits>::Normalized(const Limb* span, size_t size) {
+  while (size > 0 && span[size - 1] == 0) {
+    --size;
+  }
+  return size;
+}
+
+template<typename Traits>
+typename LimbKernels<Traits>::Limb
+LimbKernels<Traits>::Add(Limb* result, const Limb* lhs, size_t lhs_size,
+                         const Limb* rhs, size_t rhs_size) {
+  INSTRUMENT_COUNT(kLimbOperations, rhs_size);
+  assert(lhs_size >= rhs_size);
+  WideLimb carry{0};
+  size_t i{0};
+  if (rhs_size >= kLimbLoopThreshold) {
+    const LimbLoops& loops{ActiveLimbLoops()};
+    carry = (kIsBinary<Traits> ? loops.add_binary : loops.add_decimal)(
+        result, lhs, rhs, rhs_size);
+    i = rhs_size;
+  }
+  for (; i < rhs_size; ++i) {
+    WideLimb digit{WideLimb{lhs[i]} + rhs[i] + carry};
+    carry = digit >= kBase ? 1 : 0;
+    result[i] = static_cast<Limb>(digit - carry * kBase);
+  }
+  for (; i < lhs_size; ++i) {
+    if (carry == 0 && result == lhs) {
+      return 0;
+    }
+    WideLimb digit{lhs[i] + carry};
+    carry = digit >= kBase ? 1 : 0;
+    result[i] = static_cast<Limb>(digit - carry * kBase);
+  }
+  return static_cast<Limb>(carry);
+}
+template<typename Traits>
+typename LimbKernels<Traits>::Limb
+LimbKernels<Traits>::Subtract(Limb* result, const Limb* lhs, size_t lhs_size,
+                              const Limb* rhs, size_t rhs_size) {
+  INSTRUMENT_COUNT(kLimbOperations, rhs_size);
+  assert(lhs_size >= rhs_size);
+  WideLimb borrow{0};
+  size_t i{0};
+  if (rhs_size >= kLimbLoopThreshold) {
+    const LimbLoops& loops{ActiveLimbLoops()};
+    borrow = (kIsBinary<Traits> ? loops.subtract_binary
+                                : loops.subtract_decimal)(result, lhs, rhs,
+                                                          rhs_size);
+    i = rhs_size;
+  }
+  for (; i < rhs_size; ++i) {
+    WideLimb subtrahend{rhs[i] + borrow};
+    borrow = lhs[i] < subtrahend ? 1 : 0;
+    result[i] = static_cast<Limb>(lhs[i] + borrow * kBase - subtrahend);
+  }
+  for (; i < lhs_size; ++i) {
+    if (borrow == 0 && result == lhs) {
+      return 0;
+    }
+    WideLimb subtrahend{borrow};
+    borrow = lhs[i] < subtrahend ? 1 : 0;
+    result[i] = static_cast<Limb>(lhs[i] + borrow * kBase - subtrahend);
+  }
+  return static_cast<Limb>(borrow);
+}
+template<typename Traits>
+typename LimbKernels<Traits>::Limb
+LimbKernels<Traits>::AddMultipliedByShort(Limb* target, const Limb* source,
+                                          size_t size, Limb multiplier) {
+  INSTRUMENT_COUNT(kLimbOperations, size);
+  if constexpr (kIsBinary<Traits>) {
+    if (size >= kLimbLoopThreshold) {
+      return ActiveLimbLoops().add_multiplied_binary(target, source, size,
+                                                     multiplier);
+    }
+  }
+  WideLimb carry{0};
+  for (size_t i{0}; i < size; ++i) {
+    WideLimb digit{target[i] + WideLimb{source[i]} * multiplier + carry};
+    target[i] = static_cast<Limb>(digit % kBase);
+    carry = digit / kBase;
+  }
+  return static_cast<Limb>(carry);
+}
+template<typename Traits>
+typename LimbKernels<Traits>::WideLimb
+LimbKernels<Traits>::SubtractMultipliedByShort(Limb* target,
+                                               const Limb* source,
+                                               size_t size, Limb multiplier) {
+  INSTRUMENT_COUNT(kLimbOperations, size);
+  WideLimb carry{0};
+  for (size_t i{0}; i < size; ++i) {
+    WideLimb product{WideLimb{source[i]} * multiplier + carry};
+    carry = product / kBase;
+    WideLimb subtrahend{product % kBase};
+    if (target[i] < subtrahend) {
+      target[i] = static_cast<Limb>(target[i] + kBase - subtrahend);
+      ++carry;
+    } else {
+      target[i] = static_cast<Limb>(target[i] - subtrahend);
+    }
+  }
+  return carry;
+}
+template<typename Traits>
+typename LimbKernels<Traits>::Limb
+LimbKernels<Traits>::MultiplyByShort(Limb* result, const Limb* source,
+                                     size_t size, Limb multiplier) {
+  INSTRUMENT_COUNT(kLimbOperations, size);
+  WideLimb carry{0};
+  for (size_t i{0}; i < size; ++i) {
+    WideLimb digit{WideLimb{source[i]} * multiplier + carry};
+    result[i] = static_cast<Limb>(digit % kBase);
+    carry = digit / kBase;
+  }
+  return static_cast<Limb>(carry);
+}
+template<typename Traits>
+typename LimbKernels<Traits>::Limb
+LimbKernels<Traits>::DivideByShort(Limb* span, size_t size, Limb divisor) {
+  INSTRUMENT_COUNT(kLimbOperations, size);
+  WideLimb remainder{0};
+  for (size_t i{size}; i > 0; --i) {
+    WideLimb digit{remainder * kBase + span[i - 1]};
+    span[i - 1] = static_cast<Limb>(digit / divisor);
+    remainder = digit % divisor;
+  }
+  return static_cast<Limb>(remainder);
+}
+template<typename Traits>
+typename LimbKernels<Traits>::Limb
+LimbKernels<Traits>::RemainderByShort(const Limb* span, size_t size,
+                                      Limb divisor) {
+  INSTRUMENT_COUNT(kLimbOperations, size);
+  WideLimb remainder{0};
+  for (size_t i{size}; i > 0; --i) {
+    remainder = (remainder * kBase + span[i - 1]) % divisor;
+  }
+  return static_cast<Limb>(remainder);
+}
+
+template<typename Traits>
+size_t LimbKernels<Traits>::MultiplyScratchSize(size_t lhs_size,
+                                                size_t rhs_size) {
+  size_t min_size{std::min(lhs_size, rhs_size)};
+  if (min_size < kKaratsubaThreshold ||
+      (min_size >= kNttThreshold &&
+       IsNttApplicable(lhs_size, rhs_size, kBase))) {
+    return 0;
+  }
+  return 8 * std::max(lhs_size, rhs_size) + 64;
+}
+template<typename Traits>
+void LimbKernels<Traits>::Multiply(Limb* result, const Limb* lhs,
+                                   size_t lhs_size, const Limb* rhs,
+                                   size_t rhs_size, Limb* scratch) {
+  if (lhs_size < rhs_size) {
+    std::swap(lhs, rhs);
+    std::swap(lhs_size, rhs_size);
+  }
+  bool is_square{lhs == rhs && lhs_size == rhs_size};
+  if (rhs_size < kKaratsubaThreshold) {
+    if (is_square) {
+      SquareSchoolbook(result, lhs, lhs_size);
+    } else {
+      MultiplySchoolbook(result, lhs, lhs_size, rhs, rhs_size);
+    }
+  } else if (rhs_size >= kNttThreshold &&
+             IsNttApplicable(lhs_size, rhs_size, kBase)) {
+    MultiplyNtt(result, lhs, lhs_size, rhs, rhs_size, kBase);
+  } else if (2 * rhs_size <= lhs_size + 1) {
+    MultiplyUnbalanced(result, lhs, lhs_size, rhs, rhs_size, scratch);
+  } else if (rhs_size >= kToom3Threshold &&
+             rhs_size > 2 * ((lhs_size + 2) / 3)) {
+    MultiplyToom3(result, lhs, lhs_size, rhs, rhs_size, scratch);
+  } else {
+    MultiplyKaratsuba(result, lhs, lhs_size, rhs, rhs_size, scratch);
+  }
+}
+
+template<typename Traits>
+void LimbKernels<Traits>::Divide(Limb* quotient, Limb* remainder,
+                                 const Limb* dividend, size_t dividend_size,
+                                 const Limb* divisor, size_t divisor_size,
+                                 std::pmr::memory_resource* resource) {
+  assert(dividend_size >= divisor_size && divisor_size > 0);
+  assert(divisor[divisor_size - 1] != 0);
+  size_t quotient_size{dividend_size - divisor_size + 1};
+  if (divisor_size == 1) {
+    std::copy(dividend, dividend + dividend_size, quotient);
+    Limb last{DivideByShort(quotient, dividend_size, divisor[0])};
+    if (remainder) {
+      remainder[0] = last;
+    }
+  } else if (divisor_size > kBurnikelZieglerThreshold &&
+             quotient_size > kBurnikelZieglerThreshold) {
+    DivideBurnikelZiegler(quotient, remainder, dividend, dividend_size,
+                          divisor, divisor_size, resource);
+  } else {
+    DivideKnuth(quotient, remainder, dividend, dividend_size,
+                divisor, divisor_size, resource);
+  }
+}
+
+template class LimbKernels<DecimalLimbs>;
+template class LimbKernels<BinaryLimbs>;
+
+}  // namespace big_num_arithmetic::kernels
@@ -0,0 +1,130 @@
+#ifndef BIG_INTEGER_KERNELS_H_
+#define BIG_INTEGER_KERNELS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+#include "big_integer.h"
+
+// Low-level routines working on raw limb spans. A span is a pointer to the
+// least significant limb and a number of limbs; every limb is in
+// [0, Traits::kBase). None of the routines allocate memory unless stated
+// otherwise, the callers provide the output and the scratch space.
+namespace big_num_arithmetic::kernels {
+
+inline constexpr size_t kKaratsubaThreshold = 20;
+inline constexpr size_t kToom3Threshold = 160;
+inline constexpr size_t kBurnikelZieglerThreshold = 120;
+// From this operand size on Karatsuba and Toom-3 compute their partial
+// products in parallel on the default thread pool.
+inline constexpr size_t kParallelMultiplyThreshold = 1024;
+
+template<typename Traits>
+class LimbKernels {
+ public:
+  using Limb = typename Traits::Limb;
+  using WideLimb = typename Traits::WideLimb;
+  static constexpr WideLimb kBase{Traits::kBase};
+
+  // Returns -1, 0 or 1. Leading zero limbs are ignored.
+  static int Compare(const Limb* lhs, size_t lhs_size,
+                     const Limb* rhs, size_t rhs_size);
+  static size_t Normalized(const Limb* span, size_t size);
+
+  // result = lhs + rhs, lhs_size >= rhs_size. Returns the carry out of the
+  // lhs_size limbs. The result may alias either of the operands.
+  static Limb Add(Limb* result, const Limb* lhs, size_t lhs_size,
+                  const Limb* rhs, size_t rhs_size);
+  // result = lhs - rhs, lhs_size >= rhs_size. Returns the borrow out of the
+  // lhs_size limbs. The result may alias either of the operands.
+  static Limb Subtract(Limb* result, const Limb* lhs, size_t lhs_size,
+                       const Limb* rhs, size_t rhs_size);
+  // target[0, size) += source[0, size) * multiplier, returns the carry limb.
+  static Limb AddMultipliedByShort(Limb* target, const Limb* source,
+                                   size_t size, Limb multiplier);
+  // target[0, size) -= source[0, size) * multiplier, returns the value that
+  // still has to be subtracted from target[size], which is at most kBase.
+  static WideLimb SubtractMultipliedByShort(Limb* target, const Limb* source,
+                                            size_t size, Limb multiplier);
+  // result[0, size) = source[0, size) * multiplier, returns the carry limb.
+  // The result may alias the source.
+  static Limb MultiplyByShort(Limb* result, const Limb* source, size_t size,
+                              Limb multiplier);
+  // span /= divisor in place, returns the remainder.
+  static Limb DivideByShort(Limb* span, size_t size, Limb divisor);
+  // Returns span % divisor.
+  static Limb RemainderByShort(const Limb* span, size_t size, Limb divisor);
+
+  // Number of scratch limbs that Multiply needs for the given operand sizes.
+  static size_t MultiplyScratchSize(size_t lhs_size, size_t rhs_size);
+  // result[0, lhs_size + rhs_size) = lhs * rhs. The result must not overlap
+  // the operands. The algorithm is picked by operand size: schoolbook,
+  // Karatsuba, Toom-3 or NTT. Passing the same span twice selects the
+  // squaring variants. Long products fork into
+  // concurrency::ThreadPool::Default().
+  static void Multiply(Limb* result, const Limb* lhs, size_t lhs_size,
+                       const Limb* rhs, size_t rhs_size, Limb* scratch);
+  static void Square(Limb* result, const Limb* span, size_t size,
+                     Limb* scratch) {
+    Multiply(result, span, size, span, size, scratch);
+  }
+
+  // quotient[0, dividend_size - divisor_size + 1) = dividend / divisor and,
+  // unless remainder is null, remainder[0, divisor_size) = dividend % divisor.
+  // Requires dividend_size >= divisor_size and a nonzero leading divisor
+  // limb. Knuth's algorithm D is used for short operands and the
+  // Burnikel-Ziegler recursion, which runs on top of Multiply, for long ones.
+  // Allocates the normalized copies of the operands from the resource.
+  static void Divide(
+      Limb* quotient, Limb* remainder, const Limb* dividend,
+      size_t dividend_size, const Limb* divisor, size_t divisor_size,
+      std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
+
+ private:
+  static void AddAt(Limb* result, size_t result_size, size_t offset,
+                    const Limb* span, size_t size);
+  static void MultiplySchoolbook(Limb* result, const Limb* lhs,
+                                 size_t lhs_size, const Limb* rhs,
+                                 size_t rhs_size);
+  static void SquareSchoolbook(Limb* result, const Limb* span, size_t size);
+  static void MultiplyUnbalanced(Limb* result, const Limb* lhs,
+                                 size_t lhs_size, const Limb* rhs,
+                                 size_t rhs_size, Limb* scratch);
+  static void MultiplyKaratsuba(Limb* result, const Limb* lhs,
+                                size_t lhs_size, const Limb* rhs,
+                                size_t rhs_size, Limb* scratch);
+  static bool EvaluateToom3(const Limb* x, size_t part, size_t top_size,
+                            Limb* at_one, Limb* at_minus_one, Limb* at_two);
+  static void MultiplyToom3(Limb* result, const Limb* lhs, size_t lhs_size,
+                            const Limb* rhs, size_t rhs_size, Limb* scratch);
+
+  static void DivideKnuth(Limb* quotient, Limb* remainder,
+                          const Limb* dividend, size_t dividend_size,
+                          const Limb* divisor, size_t divisor_size,
+                          std::pmr::memory_resource* resource);
+  // Forked products allocate from new_delete_resource(), which unlike a
+  // caller's resource is safe to use from the pool's threads.
+  static void MultiplyWithScratch(
+      Limb* result, const Limb* lhs, size_t lhs_size, const Limb* rhs,
+      size_t rhs_size,
+      std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
+  static void DivideThreeByTwo(Limb* quotient, Limb* remainder,
+                               const Limb* dividend, const Limb* divisor,
+                               size_t half,
+                               std::pmr::memory_resource* resource);
+  static void DivideTwoByOne(Limb* quotient, Limb* remainder,
+                             const Limb* dividend, const Limb* divisor,
+                             size_t size, std::pmr::memory_resource* resource);
+  static void DivideBurnikelZiegler(Limb* quotient, Limb* remainder,
+                                    const Limb* dividend, size_t dividend_size,
+                                    const Limb* divisor, size_t divisor_size,
+                                    std::pmr::memory_resource* resource);
+};
+
+extern template class LimbKernels<DecimalLimbs>;
+extern template class LimbKernels<BinaryLimbs>;
+
+}  // namespace big_num_arithmetic::kernels
+
+#endif  // BIG_INTEGER_KERNELS_H_
@@ -0,0 +1,201 @@
+#include "big_integer_modular.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+#include <type_traits>
+
+#include "big_integer_kernels.h"
+
+namespace big_num_arithmetic {
+
+namespace {
+
+// Window width for an exponent with the given number of bits, picked so that
+// the table of odd powers stays small next to the saved multiplications.
+size_t WindowWidth(size_t bits) {
+  if (bits > 671) {
+    return 6;
+  }
+  if (bits > 239) {
+    return 5;
+  }
+  if (bits > 79) {
+    return 4;
+  }
+  if (bits > 23) {
+    return 3;
+  }
+  return bits > 7 ? 2 : 1;
+}
+
+}  // namespace
+
+template<typename Traits>
+BasicModContext<Traits>::BasicModContext(const Integer& modulus)
+    : modulus_(modulus), size_(modulus.digits_.size()) {
+  using K = kernels::LimbKernels<Traits>;
+  if (modulus.Sign() <= 0) {
+    throw std::logic_error("Modulus must be positive");
+  }
+  size_t size{this->size_};
+  std::vector<Limb> power(2 * size + 1);
+  power.back() = 1;
+  this->reciprocal_.resize(size + 2);
+  K::Divide(this->reciprocal_.data(), nullptr, power.data(), power.size(),
+            this->modulus_.digits_.data(), size);
+  this->reciprocal_.resize(
+      K::Normalized(this->reciprocal_.data(), this->reciprocal_.size()));
+
+  size_t reciprocal_size{this->reciprocal_.size()};
+  this->product_.resize(2 * size);
+  this->estimate_.resize(size + 1 + reciprocal_size);
+  this->correction_.resize(reciprocal_size + size);
+  this->accumulator_.resize(size);
+  this->multiply_scratch_.resize(
+      std::max({K::MultiplyScratchSize(size, size),
+                K::MultiplyScratchSize(size + 1, reciprocal_size),
+                K::MultiplyScratchSize(reciprocal_size, size)}));
+}
+
+template<typename Traits>
+typename BasicModContext<Traits>::Integer
+BasicModContext<Traits>::Reduce(const Integer& value) {
+  Integer result(0, value.Resource());
+  result.digits_.resize(this->size_);
+  this->ReduceInto(result.digits_.data(), value);
+  result.RemoveZeroes();
+  return result;
+}
+template<typename Traits>
+typename BasicModContext<Traits>::Integer
+BasicModContext<Traits>::Multiply(const Integer& lhs, const Integer& rhs) {
+  return this->Reduce(this->Reduce(lhs) * this->Reduce(rhs));
+}
+template<typename Traits>
+typename BasicModContext<Traits>::Integer
+BasicModContext<Traits>::Pow(const Integer& base, const Integer& exponent) {
+  if (exponent < 0) {
+    throw std::logic_error("Negative exponent");
+  }
+  constexpr size_t kLimbBits = std::countr_zero(BinaryLimbs::kBase);
+  BasicBigInteger<BinaryLimbs> converted_exponent(0, exponent.Resource());
+  if constexpr (!std::is_same_v<Traits, BinaryLimbs>) {
+    converted_exponent = BasicBigInteger<BinaryLimbs>(exponent);
+  }
+  const auto& bits{std::is_same_v<Traits, BinaryLimbs>
+                       ? exponent.digits_
+                       : converted_exponent.digits_};
+  if (bits.empty()) {
+    return this->Reduce(Integer(1, base.Resource()));
+  }
+  auto bit_at{[&bits](size_t pos) {
+    return (bits[pos / kLimbBits] >> pos % kLimbBits) & 1;
+  }};
+  size_t bit_count{(bits.size() - 1) * kLimbBits +
+                   std::bit_width(bits.back())};
+  size_t window{WindowWidth(bit_count)};
+
+  size_t size{this->size_};
+  this->powers_.resize(size << (window - 1));
+  Limb* powers{this->powers_.data()};
+  Limb* accumulator{this->accumulator_.data()};
+  this->ReduceInto(powers, base);
+  if (window > 1) {
+    this->MultiplyResidues(accumulator, powers, powers);
+    for (size_t i{1}; i < size_t{1} << (window - 1); ++i) {
+      this->MultiplyResidues(powers + i * size, powers + (i - 1) * size,
+                             accumulator);
+    }
+  }
+
+  bool is_one{true};
+  for (size_t end{bit_count}; end > 0;) {
+    if (bit_at(end - 1) == 0) {
+      if (!is_one) {
+        this->MultiplyResidues(accumulator, accumulator, accumulator);
+      }
+      --end;
+      continue;
+    }
+    size_t begin{end > window ? end - window : 0};
+    while (bit_at(begin) == 0) {
+      ++begin;
+    }
+    size_t value{0};
+    for (size_t i{end}; i > begin; --i) {
+      value = 2 * value + bit_at(i - 1);
+    }
+    const Limb* power{powers + value / 2 * size};
+    if (is_one) {
+      std::copy(power, power + size, accumulator);
+      is_one = false;
+    } else {
+      for (size_t i{begin}; i < end; ++i) {
+        this->MultiplyResidues(accumulator, accumulator, accumulator);
+      }
+      this->MultiplyResidues(accumulator, accumulator, power);
+    }
+    end = begin;
+  }
+  Integer result(0, base.Resource());
+  result.digits_.assign(accumulator, accumulator + size);
+  result.RemoveZeroes();
+  return result;
+}
+
+template<typename Traits>
+void BasicModContext<Traits>::ReduceInto(Limb* result, const Integer& value) {
+  using K = kernels::LimbKernels<Traits>;
+  size_t size{this->size_};
+  if (value.digits_.size() <= 2 * size) {
+    std::fill(std::copy(value.digits_.begin(), value.digits_.end(),
+                        this->product_.begin()),
+              this->product_.end(), 0);
+    this->ReduceProduct(result, this->product_.data());
+  } else {
+    Integer remainder{Integer::DivMod(value, this->modulus_).second};
+    std::fill(std::copy(remainder.digits_.begin(), remainder.digits_.end(),
+                        result),
+              result + size, 0);
+  }
+  if (value.is_negative && K::Normalized(result, size) != 0) {
+    K::Subtract(result, this->modulus_.digits_.data(), size, result, size);
+  }
+}
+// Barrett's reduction: with k = size_ and q the top k + 1 limbs of the
+// product, the quotient estimate q * reciprocal_ / kBase^(k + 1) is at most
+// two units too small, so the remainder modulo kBase^(k + 1) needs at most
+// two more subtractions of the modulus.
+template<typename Traits>
+void BasicModContext<Traits>::ReduceProduct(Limb* result,
+                                            const Limb* product) {
+  using K = kernels::LimbKernels<Traits>;
+  size_t size{this->size_};
+  size_t reciprocal_size{this->reciprocal_.size()};
+  const Limb* modulus{this->modulus_.digits_.data()};
+  K::Multiply(this->estimate_.data(), product + size - 1, size + 1,
+              this->reciprocal_.data(), reciprocal_size,
+              this->multiply_scratch_.data());
+  K::Multiply(this->correction_.data(), this->estimate_.data() + size + 1,
+              reciprocal_size, modulus, size, this->multiply_scratch_.data());
+  Limb* remainder{this->correction_.data()};
+  K::Subtract(remainder, product, size + 1, remainder, size + 1);
+  while (K::Compare(remainder, size + 1, modulus, size) >= 0) {
+    K::Subtract(remainder, remainder, size + 1, modulus, size);
+  }
+  std::copy(remainder, remainder + size, result);
+}
+template<typename Traits>
+void BasicModContext<Traits>::MultiplyResidues(Limb* result, const Limb* lhs,
+                                               const Limb* rhs) {
+  kernels::LimbKernels<Traits>::Multiply(
+      this->product_.data(), lhs, this->size_, rhs, this->size_,
+      this->multiply_scratch_.data());
+  this->ReduceProduct(result, this->product_.data());
+}
+
+template class BasicModContext<DecimalLimbs>;
+template class BasicModContext<BinaryLimbs>;
+
+}  // namespace big_num_arithmetic
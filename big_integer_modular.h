@@ -0,0 +1,63 @@
+#ifndef BIG_INTEGER_MODULAR_H_
+#define BIG_INTEGER_MODULAR_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "big_integer.h"
+
+namespace big_num_arithmetic {
+
+// Arithmetic modulo a fixed positive modulus. Products are reduced with
+// Barrett's method, for which the reciprocal of the modulus is computed
+// once, and powers use a sliding window over the bits of the exponent. The
+// scratch buffers are sized by the modulus and kept between the calls, so
+// after the first call a modular exponentiation allocates only its result and,
+// for decimal limbs, the binary copy of the exponent.
+template<typename Traits>
+class BasicModContext {
+ public:
+  using Integer = BasicBigInteger<Traits>;
+
+  explicit BasicModContext(const Integer& modulus);
+
+  [[nodiscard]] const Integer& Modulus() const { return this->modulus_; }
+
+  // All the results are in [0, modulus).
+  Integer Reduce(const Integer& value);
+  Integer Multiply(const Integer& lhs, const Integer& rhs);
+  Integer Pow(const Integer& base, const Integer& exponent);
+
+ private:
+  using Limb = typename Traits::Limb;
+
+  // Writes value mod modulus into result, both have size_ limbs.
+  void ReduceInto(Limb* result, const Integer& value);
+  // result = product mod modulus. The product has 2 * size_ limbs and the
+  // result size_ limbs.
+  void ReduceProduct(Limb* result, const Limb* product);
+  // result = lhs * rhs mod modulus. The result may alias the operands.
+  void MultiplyResidues(Limb* result, const Limb* lhs, const Limb* rhs);
+
+  Integer modulus_;
+  size_t size_;
+  // floor(kBase^(2 * size_) / modulus).
+  std::vector<Limb> reciprocal_;
+  std::vector<Limb> product_;
+  std::vector<Limb> estimate_;
+  std::vector<Limb> correction_;
+  std::vector<Limb> multiply_scratch_;
+  std::vector<Limb> accumulator_;
+  // Odd powers of the base for the sliding window.
+  std::vector<Limb> powers_;
+};
+
+using ModContext = BasicModContext<DecimalLimbs>;
+using BinaryModContext = BasicModContext<BinaryLimbs>;
+
+extern template class BasicModContext<DecimalLimbs>;
+extern template class BasicModContext<BinaryLimbs>;
+
+}  // namespace big_num_arithmetic
+
+#endif  // BIG_INTEGER_MODULAR_H_
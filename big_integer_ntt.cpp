@@ -0,0 +1,299 @@
+#include "big_integer_ntt.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "instrumentation.h"
+#include "thread_pool.h"
+
+namespace big_num_arithmetic::kernels {
+
+namespace {
+
+constexpr size_t kMaxTransformSize = size_t{1} << 23;
+// Transforms of this length are done for the three primes in parallel and
+// split every butterfly stage between the threads of the default pool.
+constexpr size_t kParallelTransformSize = size_t{1} << 14;
+constexpr size_t kButterflyGrain = size_t{1} << 12;
+
+template<uint32_t Mod>
+constexpr uint32_t MultiplyMod(uint32_t lhs, uint32_t rhs) {
+  return static_cast<uint32_t>(uint64_t{lhs} * rhs % Mod);
+}
+template<uint32_t Mod>
+constexpr uint32_t AddMod(uint32_t lhs, uint32_t rhs) {
+  uint32_t sum{lhs + rhs};
+  return sum >= Mod ? sum - Mod : sum;
+}
+template<uint32_t Mod>
+constexpr uint32_t SubtractMod(uint32_t lhs, uint32_t rhs) {
+  return lhs >= rhs ? lhs - rhs : lhs + Mod - rhs;
+}
+template<uint32_t Mod>
+constexpr uint32_t PowerMod(uint32_t base, uint64_t exponent) {
+  uint32_t result{1};
+  while (exponent != 0) {
+    if (exponent & 1) {
+      result = MultiplyMod<Mod>(result, base);
+    }
+    base = MultiplyMod<Mod>(base, base);
+    exponent >>= 1;
+  }
+  return result;
+}
+
+// The forward transform is a decimation in frequency, which leaves the values
+// in bit-reversed order, and the inverse one is a decimation in time that
+// takes them in that order. Pointwise products don't care about the order,
+// so no permutation is ever done.
+template<uint32_t Mod, uint32_t PrimitiveRoot>
+class Transform {
+ public:
+  void Forward(uint32_t* values, size_t size) {
+    PrepareRoots(size);
+    for (size_t length{size}; length >= 2; length /= 2) {
+      size_t half{length / 2};
+      const uint32_t* roots{roots_.data() + half};
+      ForEachButterfly(size, half, [&](size_t block, size_t first,
+                                       size_t last) {
+        uint32_t* low{values + block};
+        uint32_t* high{low + half};
+        for (size_t i{first}; i < last; ++i) {
+          uint32_t sum{AddMod<Mod>(low[i], high[i])};
+          high[i] = MultiplyMod<Mod>(SubtractMod<Mod>(low[i], high[i]),
+                                     roots[i]);
+          low[i] = sum;
+        }
+      });
+    }
+  }
+  void Inverse(uint32_t* values, size_t size) {
+    PrepareRoots(size);
+    for (size_t length{2}; length <= size; length *= 2) {
+      size_t half{length / 2};
+      const uint32_t* roots{inverse_roots_.data() + half};
+      ForEachButterfly(size, half, [&](size_t block, size_t first,
+                                       size_t last) {
+        uint32_t* low{values + block};
+        uint32_t* high{low + half};
+        for (size_t i{first}; i < last; ++i) {
+          uint32_t product{MultiplyMod<Mod>(high[i], roots[i])};
+          high[i] = SubtractMod<Mod>(low[i], product);
+          low[i] = AddMod<Mod>(low[i], product);
+        }
+      });
+    }
+    uint32_t size_inverse{PowerMod<Mod>(static_cast<uint32_t>(size % Mod),
+                                        Mod - 2)};
+    for (size_t i{0}; i < size; ++i) {
+      values[i] = MultiplyMod<Mod>(values[i], size_inverse);
+    }
+  }
+
+ private:
+  // Calls butterflies(block, first, last) for the ranges of butterflies of
+  // a stage with blocks of 2 * half values, where the block is the offset of
+  // the block and [first, last) is within [0, half).
+  template<typename Function>
+  static void ForEachButterfly(size_t size, size_t half,
+                               Function&& butterflies) {
+    INSTRUMENT_COUNT(kLimbOperations, size / 2);
+    auto run{[half, &butterflies](size_t first, size_t last) {
+      while (first < last) {
+        size_t begin{first % half};
+        size_t end{std::min(half, begin + (last - first))};
+        butterflies(first / half * 2 * half, begin, end);
+        first += end - begin;
+      }
+    }};
+    if (size >= kParallelTransformSize) {
+      concurrency::ThreadPool::Default().ParallelFor(0, size / 2,
+                                                     kButterflyGrain, run);
+    } else {
+      run(0, size / 2);
+    }
+  }
+
+  // roots_[half + i] is w^i, where w is a primitive (2 * half)-th root of
+  // unity, for every power of two half below the prepared size.
+  void PrepareRoots(size_t size) {
+    if (roots_.size() >= size) {
+      return;
+    }
+    roots_.assign(size, 0);
+    inverse_roots_.assign(size, 0);
+    for (size_t half{1}; half < size; half *= 2) {
+      uint32_t root{PowerMod<Mod>(PrimitiveRoot, (Mod - 1) / (2 * half))};
+      uint32_t inverse_root{PowerMod<Mod>(root, Mod - 2)};
+      roots_[half] = 1;
+      inverse_roots_[half] = 1;
+      for (size_t i{1}; i < half; ++i) {
+        roots_[half + i] = MultiplyMod<Mod>(roots_[half + i - 1], root);
+        inverse_roots_[half + i] =
+            MultiplyMod<Mod>(inverse_roots_[half + i - 1], inverse_root);
+      }
+    }
+  }
+
+  std::vector<uint32_t> roots_;
+  std::vector<uint32_t> inverse_roots_;
+};
+
+constexpr uint32_t kFirstPrime{998'244'353};
+constexpr uint32_t kSecondPrime{167'772'161};
+constexpr uint32_t kThirdPrime{469'762'049};
+constexpr uint32_t kFirstPrimeInverse{
+    PowerMod<kSecondPrime>(kFirstPrime % kSecondPrime, kSecondPrime - 2)};
+constexpr uint32_t kFirstTwoPrimesInverse{PowerMod<kThirdPrime>(
+    static_cast<uint32_t>(uint64_t{kFirstPrime} * kSecondPrime % kThirdPrime),
+    kThirdPrime - 2)};
+
+// Returns value % divisor and replaces value with value / divisor, using
+// 64-bit divisions only. Requires divisor <= 2^32.
+uint64_t DivideWide(unsigned __int128& value, uint64_t divisor) {
+  uint64_t high{static_cast<uint64_t>(value >> 64)};
+  uint64_t middle{static_cast<uint64_t>(value >> 32) & 0xffff'ffff};
+  uint64_t low{static_cast<uint64_t>(value) & 0xffff'ffff};
+  uint64_t high_quotient{high / divisor};
+  middle |= (high % divisor) << 32;
+  uint64_t middle_quotient{middle / divisor};
+  low |= (middle % divisor) << 32;
+  uint64_t low_quotient{low / divisor};
+  value = (static_cast<unsigned __int128>(high_quotient) << 64) |
+          (uint64_t{middle_quotient} << 32 | low_quotient);
+  return low % divisor;
+}
+
+class Engine {
+ public:
+  void Multiply(uint32_t* result, const uint32_t* lhs, size_t lhs_size,
+                const uint32_t* rhs, size_t rhs_size, uint64_t base) {
+    size_t result_size{lhs_size + rhs_size};
+    size_t transform_size{1};
+    while (transform_size < result_size - 1) {
+      transform_size *= 2;
+    }
+    bool is_square{lhs == rhs && lhs_size == rhs_size};
+    auto first{[&] {
+      MultiplyModulo<kFirstPrime>(first_transform_, residues_[0], buffers_[0],
+                                  lhs, lhs_size, rhs, rhs_size,
+                                  transform_size, is_square);
+    }};
+    auto second{[&] {
+      MultiplyModulo<kSecondPrime>(second_transform_, residues_[1],
+                                   buffers_[1], lhs, lhs_size, rhs, rhs_size,
+                                   transform_size, is_square);
+    }};
+    auto third{[&] {
+      MultiplyModulo<kThirdPrime>(third_transform_, residues_[2], buffers_[2],
+                                  lhs, lhs_size, rhs, rhs_size,
+                                  transform_size, is_square);
+    }};
+    if (transform_size >= kParallelTransformSize) {
+      concurrency::ThreadPool::Default().Invoke(first, second, third);
+    } else {
+      first();
+      second();
+      third();
+    }
+
+    unsigned __int128 carry{0};
+    for (size_t i{0}; i < result_size; ++i) {
+      if (i < result_size - 1) {
+        carry += Restore(residues_[0][i], residues_[1][i], residues_[2][i]);
+      }
+      result[i] = static_cast<uint32_t>(DivideWide(carry, base));
+    }
+  }
+
+ private:
+  template<uint32_t Mod, typename T>
+  static void MultiplyModulo(T& transform, std::vector<uint32_t>& residues,
+                             std::vector<uint32_t>& buffer,
+                             const uint32_t* lhs, size_t lhs_size,
+                             const uint32_t* rhs, size_t rhs_size,
+                             size_t transform_size, bool is_square) {
+    Load<Mod>(residues, lhs, lhs_size, transform_size);
+    transform.Forward(residues.data(), transform_size);
+    if (is_square) {
+      for (size_t i{0}; i < transform_size; ++i) {
+        residues[i] = MultiplyMod<Mod>(residues[i], residues[i]);
+      }
+    } else {
+      Load<Mod>(buffer, rhs, rhs_size, transform_size);
+      transform.Forward(buffer.data(), transform_size);
+      for (size_t i{0}; i < transform_size; ++i) {
+        residues[i] = MultiplyMod<Mod>(residues[i], buffer[i]);
+      }
+    }
+    transform.Inverse(residues.data(), transform_size);
+  }
+
+  template<uint32_t Mod>
+  static void Load(std::vector<uint32_t>& target, const uint32_t* span,
+                   size_t size, size_t transform_size) {
+    if (target.size() < transform_size) {
+      target.resize(transform_size);
+    }
+    for (size_t i{0}; i < size; ++i) {
+      target[i] = span[i] % Mod;
+    }
+    std::fill(target.begin() + size, target.begin() + transform_size, 0);
+  }
+
+  // Garner's algorithm for the three primes.
+  static unsigned __int128 Restore(uint32_t first, uint32_t second,
+                                   uint32_t third) {
+    uint32_t second_digit{MultiplyMod<kSecondPrime>(
+        SubtractMod<kSecondPrime>(second, first % kSecondPrime),
+        kFirstPrimeInverse)};
+    uint64_t partial{first + uint64_t{kFirstPrime} * second_digit};
+    uint32_t third_digit{MultiplyMod<kThirdPrime>(
+        SubtractMod<kThirdPrime>(third,
+                                 static_cast<uint32_t>(partial % kThirdPrime)),
+        kFirstTwoPrimesInverse)};
+    return partial + static_cast<unsigned __int128>(
+        uint64_t{kFirstPrime} * kSecondPrime) * third_digit;
+  }
+
+  Transform<kFirstPrime, 3> first_transform_;
+  Transform<kSecondPrime, 3> second_transform_;
+  Transform<kThirdPrime, 3> third_transform_;
+  std::vector<uint32_t> residues_[3];
+  std::vector<uint32_t> buffers_[3];
+};
+
+}  // namespace
+
+bool IsNttApplicable(size_t lhs_size, size_t rhs_size, uint64_t base) {
+  if (lhs_size + rhs_size > kMaxTransformSize) {
+    return false;
+  }
+  long double modulus{static_cast<long double>(kFirstPrime) * kSecondPrime *
+                      kThirdPrime};
+  long double largest_limb(base - 1);
+  return static_cast<long double>(std::min(lhs_size, rhs_size)) *
+         largest_limb * largest_limb < modulus;
+}
+void MultiplyNtt(uint32_t* result, const uint32_t* lhs, size_t lhs_size,
+                 const uint32_t* rhs, size_t rhs_size, uint64_t base) {
+  thread_local Engine engine;
+  thread_local bool is_engine_busy{false};
+  // A thread that waits for its parallel transforms may pick up another
+  // product, which then gets buffers of its own.
+  if (is_engine_busy) {
+    Engine().Multiply(result, lhs, lhs_size, rhs, rhs_size, base);
+    return;
+  }
+  is_engine_busy = true;
+  try {
+    engine.Multiply(result, lhs, lhs_size, rhs, rhs_size, base);
+  } catch (...) {
+    is_engine_busy = false;
+    throw;
+  }
+  is_engine_busy = false;
+}
+
+}  // namespace big_num_arithmetic::kernels
@@ -0,0 +1,26 @@
+#ifndef BIG_INTEGER_NTT_H_
+#define BIG_INTEGER_NTT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// Multiplication through number-theoretic transforms modulo three NTT-friendly
+// primes, with the product limbs restored by the Chinese remainder theorem.
+namespace big_num_arithmetic::kernels {
+
+inline constexpr size_t kNttThreshold = 128;
+
+// Whether the exact product of limbs in [0, base) fits into the three-prime
+// modulus and the transform length is supported by all the primes.
+bool IsNttApplicable(size_t lhs_size, size_t rhs_size, uint64_t base);
+// result[0, lhs_size + rhs_size) = lhs * rhs. When lhs and rhs are the same
+// span, a single forward transform per prime is done. The transform buffers
+// are kept per thread and reused across calls. Long transforms run on
+// concurrency::ThreadPool::Default().
+// Requires base <= 2^32.
+void MultiplyNtt(uint32_t* result, const uint32_t* lhs, size_t lhs_size,
+                 const uint32_t* rhs, size_t rhs_size, uint64_t base);
+
+}  // namespace big_num_arithmetic::kernels
+
+#endif  // BIG_INTEGER_NTT_H_
@@ -0,0 +1,307 @@
+#include "big_integer_simd.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BIG_INTEGER_X86_LOOPS
+#include <immintrin.h>
+#endif
+
+namespace big_num_arithmetic::kernels {
+
+namespace {
+
+constexpr uint32_t kDecimalBase{1'000'000'000};
+
+// The scalar loops take the incoming carry, so that the vector loops can
+// finish their tails with them.
+uint32_t AddDecimalFrom(uint32_t* result, const uint32_t* lhs,
+                        const uint32_t* rhs, size_t size, uint32_t carry) {
+  for (size_t i{0}; i < size; ++i) {
+    uint32_t digit{lhs[i] + rhs[i] + carry};
+    carry = digit >= kDecimalBase ? 1 : 0;
+    result[i] = digit - carry * kDecimalBase;
+  }
+  return carry;
+}
+uint32_t SubtractDecimalFrom(uint32_t* result, const uint32_t* lhs,
+                             const uint32_t* rhs, size_t size,
+                             uint32_t borrow) {
+  for (size_t i{0}; i < size; ++i) {
+    uint32_t subtrahend{rhs[i] + borrow};
+    borrow = lhs[i] < subtrahend ? 1 : 0;
+    result[i] = lhs[i] + borrow * kDecimalBase - subtrahend;
+  }
+  return borrow;
+}
+uint32_t AddBinaryFrom(uint32_t* result, const uint32_t* lhs,
+                       const uint32_t* rhs, size_t size, uint64_t carry) {
+  for (size_t i{0}; i < size; ++i) {
+    uint64_t digit{uint64_t{lhs[i]} + rhs[i] + carry};
+    result[i] = static_cast<uint32_t>(digit);
+    carry = digit >> 32;
+  }
+  return static_cast<uint32_t>(carry);
+}
+uint32_t SubtractBinaryFrom(uint32_t* result, const uint32_t* lhs,
+                            const uint32_t* rhs, size_t size,
+                            uint64_t borrow) {
+  for (size_t i{0}; i < size; ++i) {
+    uint64_t digit{uint64_t{lhs[i]} - rhs[i] - borrow};
+    result[i] = static_cast<uint32_t>(digit);
+    borrow = digit >> 63;
+  }
+  return static_cast<uint32_t>(borrow);
+}
+uint32_t AddMultipliedBinaryFrom(uint32_t* target, const uint32_t* source,
+                                 size_t size, uint32_t multiplier,
+                                 uint64_t carry) {
+  for (size_t i{0}; i < size; ++i) {
+    uint64_t digit{target[i] + uint64_t{source[i]} * multiplier + carry};
+    target[i] = static_cast<uint32_t>(digit);
+    carry = digit >> 32;
+  }
+  return static_cast<uint32_t>(carry);
+}
+
+uint32_t AddDecimalScalar(uint32_t* result, const uint32_t* lhs,
+                          const uint32_t* rhs, size_t size) {
+  return AddDecimalFrom(result, lhs, rhs, size, 0);
+}
+uint32_t SubtractDecimalScalar(uint32_t* result, const uint32_t* lhs,
+                               const uint32_t* rhs, size_t size) {
+  return SubtractDecimalFrom(result, lhs, rhs, size, 0);
+}
+uint32_t AddBinaryScalar(uint32_t* result, const uint32_t* lhs,
+                         const uint32_t* rhs, size_t size) {
+  return AddBinaryFrom(result, lhs, rhs, size, 0);
+}
+uint32_t SubtractBinaryScalar(uint32_t* result, const uint32_t* lhs,
+                              const uint32_t* rhs, size_t size) {
+  return SubtractBinaryFrom(result, lhs, rhs, size, 0);
+}
+uint32_t AddMultipliedBinaryScalar(uint32_t* target, const uint32_t* source,
+                                   size_t size, uint32_t multiplier) {
+  return AddMultipliedBinaryFrom(target, source, size, multiplier, 0);
+}
+
+#ifdef BIG_INTEGER_X86_LOOPS
+
+// The decimal vector loops add a block of lanes at once and then resolve the
+// carries between the lanes through bit masks: a lane generates a carry when
+// its sum is at least the base and passes the incoming one on when the sum
+// is base - 1. Adding the generate mask shifted by one lane to the propagate
+// mask runs the carry chain of the whole block as one integer addition, whose
+// bit i is then the carry into lane i. Borrows work the same way with
+// negative and zero differences.
+inline uint32_t IncomingCarries(uint32_t generate, uint32_t propagate,
+                                uint32_t carry) {
+  return ((generate << 1) + propagate + carry) ^ propagate;
+}
+
+__attribute__((target("avx2")))
+__m256i LaneBits(uint32_t mask) {
+  const __m256i lanes{_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)};
+  return _mm256_and_si256(
+      _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(mask)), lanes),
+      _mm256_set1_epi32(1));
+}
+__attribute__((target("avx2")))
+uint32_t LaneMask(__m256i lanes) {
+  return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(lanes)));
+}
+
+// The limbs are below 2^30 and the sums below 2^31, so the signed
+// comparisons are exact.
+__attribute__((target("avx2")))
+uint32_t AddDecimalAvx2(uint32_t* result, const uint32_t* lhs,
+                        const uint32_t* rhs, size_t size) {
+  const __m256i max_digit{_mm256_set1_epi32(kDecimalBase - 1)};
+  const __m256i base{_mm256_set1_epi32(kDecimalBase)};
+  uint32_t carry{0};
+  size_t i{0};
+  for (; i + 8 <= size; i += 8) {
+    __m256i sum{_mm256_add_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)))};
+    uint32_t carries{
+        IncomingCarries(LaneMask(_mm256_cmpgt_epi32(sum, max_digit)),
+                        LaneMask(_mm256_cmpeq_epi32(sum, max_digit)), carry)};
+    carry = carries >> 8;
+    sum = _mm256_add_epi32(sum, LaneBits(carries));
+    sum = _mm256_sub_epi32(
+        sum, _mm256_and_si256(_mm256_cmpgt_epi32(sum, max_digit), base));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), sum);
+  }
+  return AddDecimalFrom(result + i, lhs + i, rhs + i, size - i, carry);
+}
+__attribute__((target("avx2")))
+uint32_t SubtractDecimalAvx2(uint32_t* result, const uint32_t* lhs,
+                             const uint32_t* rhs, size_t size) {
+  const __m256i zero{_mm256_setzero_si256()};
+  const __m256i base{_mm256_set1_epi32(kDecimalBase)};
+  uint32_t borrow{0};
+  size_t i{0};
+  for (; i + 8 <= size; i += 8) {
+    __m256i difference{_mm256_sub_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)),
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)))};
+    uint32_t borrows{
+        IncomingCarries(LaneMask(_mm256_cmpgt_epi32(zero, difference)),
+                        LaneMask(_mm256_cmpeq_epi32(difference, zero)),
+                        borrow)};
+    borrow = borrows >> 8;
+    difference = _mm256_sub_epi32(difference, LaneBits(borrows));
+    difference = _mm256_add_epi32(
+        difference,
+        _mm256_and_si256(_mm256_cmpgt_epi32(zero, difference), base));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), difference);
+  }
+  return SubtractDecimalFrom(result + i, lhs + i, rhs + i, size - i, borrow);
+}
+
+__attribute__((target("avx512f")))
+uint32_t AddDecimalAvx512(uint32_t* result, const uint32_t* lhs,
+                          const uint32_t* rhs, size_t size) {
+  const __m512i max_digit{_mm512_set1_epi32(kDecimalBase - 1)};
+  const __m512i base{_mm512_set1_epi32(kDecimalBase)};
+  const __m512i one{_mm512_set1_epi32(1)};
+  uint32_t carry{0};
+  size_t i{0};
+  for (; i + 16 <= size; i += 16) {
+    __m512i sum{_mm512_add_epi32(_mm512_loadu_si512(lhs + i),
+                                 _mm512_loadu_si512(rhs + i))};
+    uint32_t carries{
+        IncomingCarries(_mm512_cmpgt_epu32_mask(sum, max_digit),
+                        _mm512_cmpeq_epu32_mask(sum, max_digit), carry)};
+    carry = carries >> 16;
+    sum = _mm512_mask_add_epi32(sum, static_cast<__mmask16>(carries), sum,
+                                one);
+    sum = _mm512_mask_sub_epi32(sum, _mm512_cmpgt_epu32_mask(sum, max_digit),
+                                sum, base);
+    _mm512_storeu_si512(result + i, sum);
+  }
+  return AddDecimalFrom(result + i, lhs + i, rhs + i, size - i, carry);
+}
+__attribute__((target("avx512f")))
+uint32_t SubtractDecimalAvx512(uint32_t* result, const uint32_t* lhs,
+                               const uint32_t* rhs, size_t size) {
+  const __m512i base{_mm512_set1_epi32(kDecimalBase)};
+  const __m512i one{_mm512_set1_epi32(1)};
+  uint32_t borrow{0};
+  size_t i{0};
+  for (; i + 16 <= size; i += 16) {
+    __m512i minuend{_mm512_loadu_si512(lhs + i)};
+    __m512i subtrahend{_mm512_loadu_si512(rhs + i)};
+    __m512i difference{_mm512_sub_epi32(minuend, subtrahend)};
+    uint32_t borrows{
+        IncomingCarries(_mm512_cmplt_epu32_mask(minuend, subtrahend),
+                        _mm512_cmpeq_epu32_mask(minuend, subtrahend),
+                        borrow)};
+    borrow = borrows >> 16;
+    difference = _mm512_mask_sub_epi32(
+        difference, static_cast<__mmask16>(borrows), difference, one);
+    difference = _mm512_mask_add_epi32(
+        difference,
+        _mm512_cmplt_epi32_mask(difference, _mm512_setzero_si512()),
+        difference, base);
+    _mm512_storeu_si512(result + i, difference);
+  }
+  return SubtractDecimalFrom(result + i, lhs + i, rhs + i, size - i, borrow);
+}
+
+// The binary loops run over pairs of limbs as 64-bit words, which every
+// x86-64 CPU adds with a single carry chain.
+uint64_t LoadWord(const uint32_t* limbs) {
+  uint64_t word;
+  std::memcpy(&word, limbs, sizeof(word));
+  return word;
+}
+void StoreWord(uint32_t* limbs, uint64_t word) {
+  std::memcpy(limbs, &word, sizeof(word));
+}
+
+uint32_t AddBinaryWords(uint32_t* result, const uint32_t* lhs,
+                        const uint32_t* rhs, size_t size) {
+  unsigned char carry{0};
+  size_t i{0};
+  for (; i + 2 <= size; i += 2) {
+    unsigned long long sum;
+    carry = _addcarry_u64(carry, LoadWord(lhs + i), LoadWord(rhs + i), &sum);
+    StoreWord(result + i, sum);
+  }
+  return AddBinaryFrom(result + i, lhs + i, rhs + i, size - i, carry);
+}
+uint32_t SubtractBinaryWords(uint32_t* result, const uint32_t* lhs,
+                             const uint32_t* rhs, size_t size) {
+  unsigned char borrow{0};
+  size_t i{0};
+  for (; i + 2 <= size; i += 2) {
+    unsigned long long difference;
+    borrow = _subborrow_u64(borrow, LoadWord(lhs + i), LoadWord(rhs + i),
+                            &difference);
+    StoreWord(result + i, difference);
+  }
+  return SubtractBinaryFrom(result + i, lhs + i, rhs + i, size - i, borrow);
+}
+// Two independent carry chains, one for the low halves of the products and
+// one for the carried high halves, which ADX runs side by side.
+__attribute__((target("bmi2,adx")))
+uint32_t AddMultipliedBinaryMulx(uint32_t* target, const uint32_t* source,
+                                 size_t size, uint32_t multiplier) {
+  unsigned long long carry{0};
+  unsigned char low_carry{0};
+  unsigned char high_carry{0};
+  size_t i{0};
+  for (; i + 2 <= size; i += 2) {
+    unsigned long long high;
+    unsigned long long low{_mulx_u64(LoadWord(source + i), multiplier, &high)};
+    unsigned long long word;
+    low_carry = _addcarryx_u64(low_carry, LoadWord(target + i), low, &word);
+    high_carry = _addcarryx_u64(high_carry, word, carry, &word);
+    StoreWord(target + i, word);
+    carry = high;
+  }
+  // The total carry is at most the multiplier and fits into a limb.
+  return AddMultipliedBinaryFrom(target + i, source + i, size - i, multiplier,
+                                 carry + low_carry + high_carry);
+}
+
+#endif  // BIG_INTEGER_X86_LOOPS
+
+LimbLoops SelectLimbLoops() {
+  LimbLoops loops{"scalar",
+                  AddDecimalScalar,
+                  AddBinaryScalar,
+                  SubtractDecimalScalar,
+                  SubtractBinaryScalar,
+                  AddMultipliedBinaryScalar};
+#ifdef BIG_INTEGER_X86_LOOPS
+  __builtin_cpu_init();
+  loops.name = "x86-64";
+  loops.add_binary = AddBinaryWords;
+  loops.subtract_binary = SubtractBinaryWords;
+  if (__builtin_cpu_supports("bmi2") && __builtin_cpu_supports("adx")) {
+    loops.add_multiplied_binary = AddMultipliedBinaryMulx;
+  }
+  if (__builtin_cpu_supports("avx512f")) {
+    loops.name = "avx512";
+    loops.add_decimal = AddDecimalAvx512;
+    loops.subtract_decimal = SubtractDecimalAvx512;
+  } else if (__builtin_cpu_supports("avx2")) {
+    loops.name = "avx2";
+    loops.add_decimal = AddDecimalAvx2;
+    loops.subtract_decimal = SubtractDecimalAvx2;
+  }
+#endif
+  return loops;
+}
+
+}  // namespace
+
+const LimbLoops& ActiveLimbLoops() {
+  static const LimbLoops loops{SelectLimbLoops()};
+  return loops;
+}
+
+}  // namespace big_num_arithmetic::kernels
@@ -0,0 +1,41 @@
+#ifndef BIG_INTEGER_SIMD_H_
+#define BIG_INTEGER_SIMD_H_
+
+#include <cstddef>
+#include <cstdint>
+
+// The linear limb loops specialized for the instruction sets of the running
+// CPU. The implementation is picked once, on the first use, so a single
+// binary runs the best available loops on every machine: AVX-512 or AVX2
+// for the decimal limbs, 64-bit carry chains and MULX/ADX for the binary
+// ones, and the portable scalar loops everywhere else.
+namespace big_num_arithmetic::kernels {
+
+// Below this number of limbs the kernels run their own scalar loops, which
+// is cheaper than the indirect call.
+inline constexpr size_t kLimbLoopThreshold = 16;
+
+struct LimbLoops {
+  const char* name;
+  // result[0, size) = lhs + rhs, returns the carry out. The result may alias
+  // the operands.
+  uint32_t (*add_decimal)(uint32_t* result, const uint32_t* lhs,
+                          const uint32_t* rhs, size_t size);
+  uint32_t (*add_binary)(uint32_t* result, const uint32_t* lhs,
+                         const uint32_t* rhs, size_t size);
+  // result[0, size) = lhs - rhs, returns the borrow out. The result may
+  // alias the operands.
+  uint32_t (*subtract_decimal)(uint32_t* result, const uint32_t* lhs,
+                               const uint32_t* rhs, size_t size);
+  uint32_t (*subtract_binary)(uint32_t* result, const uint32_t* lhs,
+                              const uint32_t* rhs, size_t size);
+  // target[0, size) += source[0, size) * multiplier, returns the carry limb.
+  uint32_t (*add_multiplied_binary)(uint32_t* target, const uint32_t* source,
+                                    size_t size, uint32_t multiplier);
+};
+
+const LimbLoops& ActiveLimbLoops();
+
+}  // namespace big_num_arithmetic::kernels
+
+#endif  // BIG_INTEGER_SIMD_H_
@@ -0,0 +1,177 @@
+#ifndef BIG_INTEGER_STORAGE_H_
+#define BIG_INTEGER_STORAGE_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+
+namespace big_num_arithmetic {
+
+// Contiguous limb buffer with a vector-like interface that keeps up to
+// kInlineLimbs limbs inside the object and moves to the heap only once a
+// value outgrows them, so every value that fits into an int64_t is built,
+// copied and compared without touching the allocator.
+//
+// The heap blocks come from a memory resource. Copies and moves keep the
+// resource of their source, while assignment keeps that of the target, so
+// the temporaries of a computation stay in the resource of its operands and
+// a value never ends up referring to a resource it was merely assigned from.
+template<typename Limb>
+class LimbStorage {
+ public:
+  using allocator_type = std::pmr::polymorphic_allocator<Limb>;
+
+  static constexpr uint32_t kInlineLimbs = 8;
+
+  LimbStorage() = default;
+  explicit LimbStorage(std::pmr::memory_resource* resource)
+      : resource_(resource) {}
+  LimbStorage(const LimbStorage& source)
+      : LimbStorage(source, source.resource_) {}
+  LimbStorage(const LimbStorage& source, std::pmr::memory_resource* resource)
+      : resource_(resource) {
+    this->assign(source.begin(), source.end());
+  }
+  LimbStorage(LimbStorage&& source) noexcept : resource_(source.resource_) {
+    this->StealFrom(source);
+  }
+  ~LimbStorage() { this->ReleaseMemory(); }
+
+  LimbStorage& operator=(const LimbStorage& rhs) {
+    if (this != &rhs) {
+      this->assign(rhs.begin(), rhs.end());
+    }
+    return *this;
+  }
+  // Copies the limbs when the resources differ.
+  LimbStorage& operator=(LimbStorage&& rhs) {
+    if (this == &rhs) {
+      return *this;
+    }
+    if (*this->resource_ != *rhs.resource_) {
+      return *this = rhs;
+    }
+    this->ReleaseMemory();
+    this->StealFrom(rhs);
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const {
+    return allocator_type(this->resource_);
+  }
+
+  [[nodiscard]] size_t size() const { return this->size_; }
+  [[nodiscard]] size_t capacity() const { return this->capacity_; }
+  [[nodiscard]] bool empty() const { return this->size_ == 0; }
+  [[nodiscard]] bool IsInline() const { return this->data_ == this->inline_; }
+
+  Limb* data() { return this->data_; }
+  const Limb* data() const { return this->data_; }
+  Limb* begin() { return this->data_; }
+  const Limb* begin() const { return this->data_; }
+  Limb* end() { return this->data_ + this->size_; }
+  const Limb* end() const { return this->data_ + this->size_; }
+
+  Limb& operator[](size_t pos) { return this->data_[pos]; }
+  const Limb& operator[](size_t pos) const { return this->data_[pos]; }
+  Limb& at(size_t pos) {
+    this->ThrowIfOutOfRange(pos);
+    return this->data_[pos];
+  }
+  const Limb& at(size_t pos) const {
+    this->ThrowIfOutOfRange(pos);
+    return this->data_[pos];
+  }
+  Limb& back() { return this->data_[this->size_ - 1]; }
+  const Limb& back() const { return this->data_[this->size_ - 1]; }
+
+  void reserve(size_t capacity) {
+    if (capacity > this->capacity_) {
+      this->Reallocate(capacity);
+    }
+  }
+  // New limbs are zero.
+  void resize(size_t size) {
+    if (size > this->capacity_) {
+      this->Reallocate(std::max(size, 2 * this->capacity()));
+    }
+    if (size > this->size_) {
+      std::fill(this->data_ + this->size_, this->data_ + size, 0);
+    }
+    this->size_ = static_cast<uint32_t>(size);
+  }
+  void clear() { this->size_ = 0; }
+  void push_back(Limb limb) {
+    if (this->size_ == this->capacity_) {
+      this->Reallocate(2 * this->capacity());
+    }
+    this->data_[this->size_++] = limb;
+  }
+  template<typename Iter>
+  void assign(Iter first, Iter last) {
+    size_t size(std::distance(first, last));
+    if (size > this->capacity_) {
+      this->ReleaseMemory();
+      this->Allocate(size);
+    }
+    std::copy(first, last, this->data_);
+    this->size_ = static_cast<uint32_t>(size);
+  }
+
+ private:
+  void ThrowIfOutOfRange(size_t pos) const {
+    if (pos >= this->size_) {
+      throw std::out_of_range("Limb index out of range");
+    }
+  }
+  void Allocate(size_t capacity) {
+    this->data_ = this->get_allocator().allocate(capacity);
+    this->capacity_ = static_cast<uint32_t>(capacity);
+  }
+  void Reallocate(size_t capacity) {
+    Limb* old_data{this->data_};
+    size_t old_capacity{this->capacity_};
+    this->Allocate(capacity);
+    std::copy(old_data, old_data + this->size_, this->data_);
+    if (old_data != this->inline_) {
+      this->get_allocator().deallocate(old_data, old_capacity);
+    }
+  }
+  void ReleaseMemory() {
+    if (!this->IsInline()) {
+      this->get_allocator().deallocate(this->data_, this->capacity_);
+      this->ResetFields();
+    }
+  }
+  void ResetFields() {
+    this->data_ = this->inline_;
+    this->size_ = 0;
+    this->capacity_ = kInlineLimbs;
+  }
+  // Requires this storage to be inline and both to share the resource.
+  void StealFrom(LimbStorage& source) {
+    if (source.IsInline()) {
+      std::copy(source.begin(), source.end(), this->inline_);
+      this->size_ = source.size_;
+    } else {
+      this->data_ = source.data_;
+      this->size_ = source.size_;
+      this->capacity_ = source.capacity_;
+      source.ResetFields();
+    }
+  }
+
+  std::pmr::memory_resource* resource_{std::pmr::get_default_resource()};
+  Limb* data_{inline_};
+  uint32_t size_{0};
+  uint32_t capacity_{kInlineLimbs};
+  Limb inline_[kInlineLimbs];
+};
+
+}  // namespace big_num_arithmetic
+
+#endif  // BIG_INTEGER_STORAGE_H_
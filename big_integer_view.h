@@ -0,0 +1,107 @@
+#ifndef BIG_INTEGER_VIEW_H_
+#define BIG_INTEGER_VIEW_H_
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <utility>
+
+#include "big_integer.h"
+
+namespace big_num_arithmetic {
+
+// Read-only signed value over limbs owned by someone else, such as a
+// BasicBigInteger or a memory-mapped file in the binary format. Views
+// compare with each other and with integers and serve as the operands of
+// arithmetic without copying their limbs. The limbs must outlive the view.
+template<typename Traits>
+class BasicBigIntegerView {
+ public:
+  using Integer = BasicBigInteger<Traits>;
+  using Limb = typename Traits::Limb;
+
+  BasicBigIntegerView() = default;
+  // Implicit, so that integers go wherever views are expected.
+  BasicBigIntegerView(const Integer& value)
+      : limbs_(value.Magnitude()), is_negative_(value.Sign() < 0) {}
+  // The limbs are the little-endian magnitude, every one of them below
+  // Traits::kBase. Leading zero limbs are ignored.
+  BasicBigIntegerView(std::span<const Limb> limbs, bool is_negative);
+  // Points at the limbs of a value in the format written by
+  // BasicBigInteger::Serialize. Throws std::runtime_error unless the input
+  // is a valid value with the same limbs, aligned for Limb, on a
+  // little-endian machine.
+  static BasicBigIntegerView FromSerialized(std::span<const std::byte> input);
+
+  [[nodiscard]] std::span<const Limb> Magnitude() const { return this->limbs_; }
+  [[nodiscard]] int Sign() const {
+    return this->limbs_.empty() ? 0 : this->is_negative_ ? -1 : 1;
+  }
+
+  friend bool operator==(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Compare(lhs, rhs) == 0;
+  }
+  friend bool operator!=(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Compare(lhs, rhs) != 0;
+  }
+  friend bool operator<(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Compare(lhs, rhs) < 0;
+  }
+  friend bool operator>(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Compare(lhs, rhs) > 0;
+  }
+  friend bool operator<=(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Compare(lhs, rhs) <= 0;
+  }
+  friend bool operator>=(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Compare(lhs, rhs) >= 0;
+  }
+
+  friend Integer operator+(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    Integer result(lhs);
+    result += rhs;
+    return result;
+  }
+  friend Integer operator-(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    Integer result(lhs);
+    result -= rhs;
+    return result;
+  }
+  friend Integer operator*(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Product(lhs, rhs);
+  }
+  friend Integer operator/(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Divide(lhs, rhs, false).first;
+  }
+  friend Integer operator%(BasicBigIntegerView lhs, BasicBigIntegerView rhs) {
+    return Divide(lhs, rhs, true).second;
+  }
+
+ private:
+  friend Integer;
+
+  static int Compare(BasicBigIntegerView lhs, BasicBigIntegerView rhs);
+  // The results and the scratch space are allocated from the resource.
+  static Integer Product(
+      BasicBigIntegerView lhs, BasicBigIntegerView rhs,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+  // The truncated quotient and, when asked for, the remainder, which takes
+  // the sign of the dividend.
+  static std::pair<Integer, Integer> Divide(
+      BasicBigIntegerView dividend, BasicBigIntegerView divisor,
+      bool needs_remainder,
+      std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+  std::span<const Limb> limbs_;
+  bool is_negative_{false};
+};
+
+using BigIntegerView = BasicBigIntegerView<DecimalLimbs>;
+using BinaryBigIntegerView = BasicBigIntegerView<BinaryLimbs>;
+
+extern template class BasicBigIntegerView<DecimalLimbs>;
+extern template class BasicBigIntegerView<BinaryLimbs>;
+
+}  // namespace big_num_arithmetic
+
+#endif  // BIG_INTEGER_VIEW_H_
@@ -1,18 +1,39 @@
 #ifndef BINARY_SEARCH_TREE_H_
 #define BINARY_SEARCH_TREE_H_
 
+#include <algorithm>
+#include <bit>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <queue>
-#include <stack>
 
-template<typename T>
+#include "instrumentation.h"
+#include "node_pool.h"
+#include "thread_pool.h"
+
+enum class TreeBalancing {
+  // Nodes stay where they were inserted, sorted input makes a list.
+  kNone,
+  // AVL rotations keep the depth below 1.45 log2(n).
+  kAvl,
+};
+
+// Sorted multiset. Equal values are kept in insertion order. The nodes come
+// from a pool owned by the tree, which gets its slabs through Allocator, so
+// trees can share a pooling allocator such as a std::pmr one.
+template<typename T, TreeBalancing Balancing = TreeBalancing::kAvl,
+         typename Allocator = std::allocator<T>>
 class BinarySearchTree {
  private:
+  using AllocatorTraits = std::allocator_traits<Allocator>;
+
   struct TreeNode {
-    template<typename U>
-    explicit TreeNode(U&& source) : value(std::forward<U>(source)) {}
     template<typename... Ts>
-    explicit TreeNode(Ts... args) : value(args...) {}
+    explicit TreeNode(Ts&&... args) : value(std::forward<Ts>(args)...) {}
 
     void EntangleLeft(TreeNode* child) {
       left = child;
@@ -26,18 +47,48 @@ class BinarySearchTree {
         child->parent = this;
       }
     }
-    void ReleaseParent() {
-      if (!parent) {
-        return;
+    [[nodiscard]] TreeNode* Leftmost() {
+      TreeNode* node{this};
+      while (node->left) {
+        node = node->left;
+      }
+      return node;
+    }
+    [[nodiscard]] TreeNode* Rightmost() {
+      TreeNode* node{this};
+      while (node->right) {
+        node = node->right;
+      }
+      return node;
+    }
+    [[nodiscard]] TreeNode* Next() {
+      if (right) {
+        return right->Leftmost();
+      }
+      TreeNode* node{this};
+      while (node->parent && node->parent->right == node) {
+        node = node->parent;
+      }
+      return node->parent;
+    }
+    [[nodiscard]] TreeNode* Previous() {
+      if (left) {
+        return left->Rightmost();
       }
-      (parent->right == this ? parent->right : parent->left) = nullptr;
-      parent = nullptr;
+      TreeNode* node{this};
+      while (node->parent && node->parent->left == node) {
+        node = node->parent;
+      }
+      return node->parent;
     }
 
     T value;
     TreeNode* left{nullptr};
     TreeNode* right{nullptr};
     TreeNode* parent{nullptr};
+    // Of the subtree rooted here, a leaf has height 1 and size 1.
+    int height{1};
+    int size{1};
   };
 
  public:
@@ -69,25 +120,59 @@ class BinarySearchTree {
     const BinarySearchTree* parent_;
   };
 
+  using allocator_type = Allocator;
+
   BinarySearchTree() = default;
-  BinarySearchTree(std::initializer_list<T>);
-  BinarySearchTree(const BinarySearchTree& source) {
+  explicit BinarySearchTree(const Allocator& allocator) : pool_(allocator) {}
+  BinarySearchTree(std::initializer_list<T> list,
+                   const Allocator& allocator = Allocator())
+      : BinarySearchTree(list.begin(), list.end(), allocator) {}
+  template<std::input_iterator Iterator>
+  BinarySearchTree(Iterator first, Iterator last,
+                   const Allocator& allocator = Allocator())
+      : pool_(allocator) {
+    insert_range(first, last);
+  }
+  // The copy lays its nodes out contiguously in sorted order.
+  BinarySearchTree(const BinarySearchTree& source)
+      : pool_(AllocatorTraits::select_on_container_copy_construction(
+            source.get_allocator())) {
     CopyFrom(source);
   }
-  BinarySearchTree(BinarySearchTree&& source) noexcept {
+  BinarySearchTree(BinarySearchTree&& source) noexcept
+      : pool_(source.get_allocator()) {
     MoveFrom(std::move(source));
   }
   ~BinarySearchTree() { ReleaseMemoryAndReset(); }
   BinarySearchTree& operator=(const BinarySearchTree&);
-  BinarySearchTree& operator=(BinarySearchTree&&) noexcept;
+  // Copies the values when the allocators differ.
+  BinarySearchTree& operator=(BinarySearchTree&&) noexcept(
+      AllocatorTraits::is_always_equal::value);
+
+  [[nodiscard]] allocator_type get_allocator() const {
+    return pool_.get_allocator();
+  }
 
   [[nodiscard]] int size() const { return size_; }
   [[nodiscard]] bool empty() const { return size() == 0; }
   [[nodiscard]] bool contains(const T& value) const {
     return find(value) != end();
   }
-  [[nodiscard]] int count(const T&) const;
+  // Counting takes O(log n) in the balanced tree, however many values
+  // are equal.
+  [[nodiscard]] int count(const T& value) const {
+    return CountBelow<true>(value) - CountBelow<false>(value);
+  }
+  // The number of values in [lo, hi].
+  [[nodiscard]] int count_between(const T& lo, const T& hi) const {
+    return hi < lo ? 0 : CountBelow<true>(hi) - CountBelow<false>(lo);
+  }
+  // The number of values less than the given one.
+  [[nodiscard]] int rank(const T& value) const {
+    return CountBelow<false>(value);
+  }
   [[nodiscard]] std::vector<T> to_vector() const;
+  void clear() { ReleaseMemoryAndReset(); }
 
   [[nodiscard]] ConstIterator begin() const {
     return ConstIterator(begin_, this);
@@ -95,93 +180,182 @@ class BinarySearchTree {
   [[nodiscard]] ConstIterator end() const {
     return ConstIterator(nullptr, this);
   }
+  // The first of the equal values, if any.
   [[nodiscard]] ConstIterator find(const T&) const;
+  // The value of rank k in sorted order, or end() if there is none.
+  [[nodiscard]] ConstIterator nth(int k) const;
 
+  // Both take O(log n) in the balanced tree.
   template<typename U>
-  void insert(U&& value) { insert(new TreeNode(T(std::forward<U>(value)))); }
+  void insert(U&& value) { insert(pool_.New(T(std::forward<U>(value)))); }
   template<typename... Ts>
-  void emplace(Ts... args) { insert(new TreeNode(args...)); }
+  void emplace(Ts&&... args) {
+    insert(pool_.New(std::forward<Ts>(args)...));
+  }
+  // A sorted range that is not much smaller than the tree is merged with it
+  // into a perfectly balanced tree in O(n), any other range is inserted
+  // value by value.
+  template<std::input_iterator Iterator>
+  void insert_range(Iterator first, Iterator last);
   void erase(const T& value) { erase(find(value)); }
+  // Other iterators stay valid, the successor takes the place of the node.
   void erase(ConstIterator);
 
+  // Set operations that treat equal values like std::set_union and the
+  // others do. They cut both trees apart around the values of one and join
+  // the pieces back, in O(m log(n/m + 1)) for sizes m <= n in the balanced
+  // tree, and work on the two halves in parallel above kParallelCutoff
+  // values. The nodes of other are reused, so other is best moved in.
+  //
+  // Moves all values of other into the tree, after the equal ones here.
+  void merge(BinarySearchTree& other) { Combine<kMerge>(other); }
+  void merge(BinarySearchTree&& other) { Combine<kMerge>(other); }
+  void union_with(BinarySearchTree other) { Combine<kUnion>(other); }
+  void intersect(BinarySearchTree other) { Combine<kIntersection>(other); }
+  void difference(BinarySearchTree other) { Combine<kDifference>(other); }
+
+  // Both take O(log n) in the balanced tree. Moves the values that are not
+  // less than the key into the returned tree. The two trees then share the
+  // slabs of the pool but may be used from different threads.
+  [[nodiscard]] BinarySearchTree split(const T& key);
+  // Appends the values of other, none of which may be less than a value
+  // here.
+  void join(BinarySearchTree other);
+
   bool operator==(const BinarySearchTree&) const;
   bool operator!=(const BinarySearchTree& rhs) const {
     return !(*this == rhs);
   }
+  // Whether the links, order, sizes, heights and, in the balanced tree, the
+  // balance of every node are consistent. Takes O(n), meant for tests.
+  [[nodiscard]] bool IsValid() const;
 
  private:
+  static int Height(const TreeNode* node) { return node ? node->height : 0; }
+  static int Size(const TreeNode* node) { return node ? node->size : 0; }
+  static void UpdateHeight(TreeNode* node) {
+    node->height = 1 + std::max(Height(node->left), Height(node->right));
+  }
+  static void UpdateSizeAndHeight(TreeNode* node) {
+    node->size = 1 + Size(node->left) + Size(node->right);
+    UpdateHeight(node);
+  }
+  static void AddToSizes(TreeNode* node, int delta) {
+    for (; node; node = node->parent) {
+      node->size += delta;
+    }
+  }
+
+  enum SetOperation { kMerge, kUnion, kIntersection, kDifference };
+  static constexpr int kParallelCutoff = 1 << 14;
+
+  // Calls visit(node) for the nodes of the subtree in post-order, with the
+  // node already cut off its parent.
+  template<typename Function>
+  static void CutPostOrder(TreeNode* root, Function visit);
+  // Destroys the values, if they need it, and then drops the whole pool.
   void ReleaseMemoryAndReset();
   void CopyFrom(const BinarySearchTree&);
+  // Requires both trees to have equal allocators.
   void MoveFrom(BinarySearchTree&&);
   void CopyFieldsFrom(const BinarySearchTree&);
-  void CopyUnder(TreeNode**, const TreeNode*);
-  void UpdateBeginAndRbegin();
   void insert(TreeNode*);
-  void ReturnToTree(TreeNode*);
+  // Requires the tree to be empty.
+  void BuildFrom(std::vector<T>&& sorted);
+  // Links the nodes, which are in sorted order, into a perfectly balanced
+  // tree and returns its root.
+  static TreeNode* Link(TreeNode* const* nodes, int count);
+  // The first node that is not less than the value.
+  [[nodiscard]] TreeNode* LowerBound(const T&) const;
+  // The number of values less than the given one, or with kOrEqual, not
+  // greater than it.
+  template<bool kOrEqual>
+  [[nodiscard]] int CountBelow(const T&) const;
+  // Puts the replacement, which may be null, where the node hangs.
+  void Replace(TreeNode* node, TreeNode* replacement);
+  // Like Replace, but leaves root_ alone.
+  static void ReplaceInParent(TreeNode* node, TreeNode* replacement);
+  // Both return the new root of the subtree and leave root_ alone.
+  static TreeNode* RotateLeft(TreeNode*);
+  static TreeNode* RotateRight(TreeNode*);
+  // Restores the size, height and balance of a node whose subtrees are
+  // balanced and differ in height by at most 2, and returns the new root
+  // of its subtree.
+  static TreeNode* Rebalance(TreeNode*);
+  // Restores the heights, and in the balanced tree the balance, on the
+  // path from the node up to the first subtree whose height is unchanged.
+  void Retrace(TreeNode*);
+  // Rebalances the path up to the root, which it returns.
+  static TreeNode* RetraceToRoot(TreeNode*);
 
+  // The helpers below take and return detached subtrees by their roots.
+  // None of them allocates, so they may run on disjoint subtrees at once.
+  static TreeNode* Detach(TreeNode* node) {
+    if (node) {
+      node->parent = nullptr;
+    }
+    return node;
+  }
+  // All values of left precede the middle node, which precedes all values
+  // of right. Both take O(log n).
+  static TreeNode* Join(TreeNode* left, TreeNode* middle, TreeNode* right);
+  static TreeNode* Join(TreeNode* left, TreeNode* right);
+  // Splits off the values less than the key, or with kOrEqual, not greater
+  // than it.
+  template<bool kOrEqual>
+  static std::pair<TreeNode*, TreeNode*> Split(TreeNode*, const T& key);
+  // Splits off the first count values.
+  static std::pair<TreeNode*, TreeNode*> SplitAt(TreeNode*, int count);
+  // Puts the subtrees that drop out of the result into dropped.
+  template<SetOperation kOperation>
+  static TreeNode* Combine(TreeNode* lhs, TreeNode* rhs,
+                           std::vector<TreeNode*>& dropped);
+  // Leaves other empty.
+  template<SetOperation kOperation>
+  void Combine(BinarySearchTree& other);
+  void ResetRoot(TreeNode*);
+
+  containers::NodePool<TreeNode, Allocator> pool_;
   int size_{0};
   TreeNode* root_{nullptr};
   TreeNode* begin_{nullptr};
   TreeNode* rbegin_{nullptr};
 };
-template<typename T>
-typename BinarySearchTree<T>::ConstIterator
-BinarySearchTree<T>::ConstIterator::operator++(int) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::ConstIterator
+BinarySearchTree<T, Balancing, Allocator>::ConstIterator::operator++(int) {
   auto copy{*this};
   ++*this;
   return copy;
 }
-template<typename T>
-typename BinarySearchTree<T>::ConstIterator
-BinarySearchTree<T>::ConstIterator::operator--(int) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::ConstIterator
+BinarySearchTree<T, Balancing, Allocator>::ConstIterator::operator--(int) {
   auto copy{*this};
   --*this;
   return copy;
 }
-template<typename T>
-bool BinarySearchTree<T>::ConstIterator::operator==(
+template<typename T, TreeBalancing Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::ConstIterator::operator==(
     BinarySearchTree::ConstIterator rhs) const {
   return ptr_ == rhs.ptr_;
 }
-template<typename T>
-typename BinarySearchTree<T>::ConstIterator&
-BinarySearchTree<T>::ConstIterator::operator++() {
-  if (ptr_->right) {
-    ptr_ = ptr_->right;
-    while (ptr_->left) {
-      ptr_ = ptr_->left;
-    }
-    return *this;
-  }
-  while (ptr_->parent && !(ptr_->value < ptr_->parent->value)) {
-    ptr_ = ptr_->parent;
-  }
-  ptr_ = ptr_->parent;
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::ConstIterator&
+BinarySearchTree<T, Balancing, Allocator>::ConstIterator::operator++() {
+  ptr_ = ptr_->Next();
   return *this;
 }
-template<typename T>
-typename BinarySearchTree<T>::ConstIterator&
-BinarySearchTree<T>::ConstIterator::operator--() {
-  if (!ptr_) {
-    ptr_ = parent_->rbegin_;
-    return *this;
-  }
-  if (ptr_->left) {
-    ptr_ = ptr_->left;
-    while (ptr_->right) {
-      ptr_ = ptr_->right;
-    }
-    return *this;
-  }
-  while (ptr_->parent && ptr_->value < ptr_->parent->value) {
-    ptr_ = ptr_->parent;
-  }
-  ptr_ = ptr_->parent;
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::ConstIterator&
+BinarySearchTree<T, Balancing, Allocator>::ConstIterator::operator--() {
+  ptr_ = ptr_ ? ptr_->Previous() : parent_->rbegin_;
   return *this;
 }
-template<typename T>
-BinarySearchTree<T>&
-BinarySearchTree<T>::operator=(const BinarySearchTree& rhs) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>&
+BinarySearchTree<T, Balancing, Allocator>::operator=(
+    const BinarySearchTree& rhs) {
   if (this == &rhs) {
     return *this;
   }
@@ -189,63 +363,50 @@ BinarySearchTree<T>::operator=(const BinarySearchTree& rhs) {
   CopyFrom(rhs);
   return *this;
 }
-template<typename T>
-BinarySearchTree<T>&
-BinarySearchTree<T>::operator=(BinarySearchTree&& rhs) noexcept {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>&
+BinarySearchTree<T, Balancing, Allocator>::operator=(
+    BinarySearchTree&& rhs) noexcept(AllocatorTraits::is_always_equal::value) {
   if (this == &rhs) {
     return *this;
   }
   ReleaseMemoryAndReset();
-  MoveFrom(std::move(rhs));
+  if (get_allocator() == rhs.get_allocator()) {
+    MoveFrom(std::move(rhs));
+  } else {
+    CopyFrom(rhs);
+  }
   return *this;
 }
-template<typename T>
-std::vector<T> BinarySearchTree<T>::to_vector() const {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+std::vector<T> BinarySearchTree<T, Balancing, Allocator>::to_vector() const {
   std::vector<T> result;
+  result.reserve(size_);
   for (const T& value : *this) {
     result.push_back(value);
   }
   return result;
 }
-template<typename T>
-void BinarySearchTree<T>::MoveFrom(BinarySearchTree&& source) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::MoveFrom(
+    BinarySearchTree&& source) {
+  pool_ = std::move(source.pool_);
   CopyFieldsFrom(source);
   source.CopyFieldsFrom(BinarySearchTree());
 }
-template<typename T>
-typename BinarySearchTree<T>::ConstIterator
-BinarySearchTree<T>::find(const T& target) const {
-  TreeNode* candidate{root_};
-  while (candidate) {
-    if (candidate->value == target) {
-      return ConstIterator(candidate, this);
-    }
-    candidate = candidate->value < target ? candidate->right : candidate->left;
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::ConstIterator
+BinarySearchTree<T, Balancing, Allocator>::find(const T& target) const {
+  TreeNode* candidate{LowerBound(target)};
+  INSTRUMENT_COUNT(kComparisons, candidate ? 1 : 0);
+  if (candidate && candidate->value == target) {
+    return ConstIterator(candidate, this);
   }
   return end();
 }
-template<typename T>
-BinarySearchTree<T>::BinarySearchTree(std::initializer_list<T> list) {
-  for (const T& value : list) {
-    insert(value);
-  }
-}
-template<typename T>
-int BinarySearchTree<T>::count(const T& value) const {
-  ConstIterator search_result{find(value)};
-  if (search_result == end()) {
-    return 0;
-  }
-  int accumulator{1};
-  TreeNode* node{search_result.ptr_->right};
-  while (node && node->value == value) {
-    node = node->right;
-    ++accumulator;
-  }
-  return accumulator;
-}
-template<typename T>
-bool BinarySearchTree<T>::operator==(const BinarySearchTree& rhs) const {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::operator==(
+    const BinarySearchTree& rhs) const {
   if (size() != rhs.size()) {
     return false;
   }
@@ -260,159 +421,615 @@ bool BinarySearchTree<T>::operator==(const BinarySearchTree& rhs) const {
   }
   return true;
 }
-template<typename T>
-void BinarySearchTree<T>::CopyFieldsFrom(const BinarySearchTree& source) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::IsValid() const {
+  if (Size(root_) != size_ || (root_ && root_->parent)) {
+    return false;
+  }
+  // A node is checked once both its subtrees are, in post-order.
+  std::vector<std::pair<const TreeNode*, bool>> pending;
+  if (root_) {
+    pending.push_back({root_, false});
+  }
+  while (!pending.empty()) {
+    auto [node, is_expanded]{pending.back()};
+    if (!is_expanded) {
+      pending.back().second = true;
+      for (const TreeNode* child : {node->left, node->right}) {
+        if (child) {
+          if (child->parent != node) {
+            return false;
+          }
+          pending.push_back({child, false});
+        }
+      }
+      continue;
+    }
+    pending.pop_back();
+    int balance{Height(node->left) - Height(node->right)};
+    if (node->size != 1 + Size(node->left) + Size(node->right) ||
+        node->height != 1 + std::max(Height(node->left),
+                                     Height(node->right)) ||
+        (Balancing == TreeBalancing::kAvl && (balance < -1 || balance > 1))) {
+      return false;
+    }
+  }
+  const TreeNode* previous{nullptr};
+  int count{0};
+  for (ConstIterator iter{begin()}; iter != end(); ++iter, ++count) {
+    if (previous && *iter < previous->value) {
+      return false;
+    }
+    previous = iter.ptr_;
+  }
+  return count == size_ && previous == rbegin_;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::CopyFieldsFrom(
+    const BinarySearchTree& source) {
   size_ = source.size_;
   root_ = source.root_;
   begin_ = source.begin_;
   rbegin_ = source.rbegin_;
 }
-template<typename T>
-void BinarySearchTree<T>::ReleaseMemoryAndReset() {
-  std::queue<TreeNode*> nodes_to_delete;
-  if (root_) {
-    nodes_to_delete.push(root_);
-  }
-  while (!nodes_to_delete.empty()) {
-    TreeNode* front{nodes_to_delete.front()};
-    if (front->right) {
-      nodes_to_delete.push(front->right);
-    }
-    if (front->left) {
-      nodes_to_delete.push(front->left);
+template<typename T, TreeBalancing Balancing, typename Allocator>
+template<typename Function>
+void BinarySearchTree<T, Balancing, Allocator>::CutPostOrder(TreeNode* root,
+                                                             Function visit) {
+  TreeNode* node{root};
+  while (node) {
+    if (node->left) {
+      node = node->left;
+    } else if (node->right) {
+      node = node->right;
+    } else {
+      TreeNode* parent{node == root ? nullptr : node->parent};
+      if (parent) {
+        (parent->left == node ? parent->left : parent->right) = nullptr;
+      }
+      visit(node);
+      node = parent;
     }
-    nodes_to_delete.pop();
-    delete front;
   }
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::ReleaseMemoryAndReset() {
+  if constexpr (!std::is_trivially_destructible_v<T>) {
+    CutPostOrder(root_, [](TreeNode* node) { std::destroy_at(node); });
+  }
+  pool_.Release();
   size_ = 0;
   root_ = nullptr;
   begin_ = nullptr;
   rbegin_ = nullptr;
 }
-template<typename T>
-void BinarySearchTree<T>::CopyFrom(const BinarySearchTree& source) {
-  CopyUnder(&root_, source.root_);
-  size_ = source.size();
-  begin_ = root_;
-  rbegin_ = root_;
-  UpdateBeginAndRbegin();
-}
-template<typename T>
-void BinarySearchTree<T>::CopyUnder(BinarySearchTree::TreeNode** target,
-                                    const BinarySearchTree::TreeNode* source) {
-  if (!source) {
-    return;
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::CopyFrom(
+    const BinarySearchTree& source) {
+  // A source node on the path of the in-order walk.
+  struct Pending {
+    const TreeNode* node;
+    // The copy of the parent when the node is a right child.
+    TreeNode* right_parent;
+    // The copy of the left child once it is made.
+    TreeNode* left_child;
+  };
+  std::vector<Pending> path;
+  auto descend = [&path](const TreeNode* node, TreeNode* right_parent) {
+    for (; node; node = node->left, right_parent = nullptr) {
+      path.push_back({node, right_parent, nullptr});
+    }
+  };
+  pool_.Reserve(source.size());
+  descend(source.root_, nullptr);
+  while (!path.empty()) {
+    Pending pending{path.back()};
+    path.pop_back();
+    TreeNode* copy{pool_.New(pending.node->value)};
+    copy->height = pending.node->height;
+    copy->size = pending.node->size;
+    copy->EntangleLeft(pending.left_child);
+    if (pending.right_parent) {
+      pending.right_parent->EntangleRight(copy);
+    } else if (!path.empty()) {
+      path.back().left_child = copy;
+    } else {
+      root_ = copy;
+    }
+    if (!begin_) {
+      begin_ = copy;
+    }
+    rbegin_ = copy;
+    descend(pending.node->right, copy);
   }
-  *target = new typename BinarySearchTree<T>::TreeNode{source->value};
-  CopyUnder(&(*target)->left, source->left);
-  if ((*target)->left) {
-    (*target)->left->parent = *target;
+  size_ = source.size();
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::LowerBound(
+    const T& value) const {
+  TreeNode* result{nullptr};
+  TreeNode* candidate{root_};
+  while (candidate) {
+    INSTRUMENT_COUNT(kTreeLevels, 1);
+    INSTRUMENT_COUNT(kComparisons, 1);
+    if (candidate->value < value) {
+      candidate = candidate->right;
+    } else {
+      result = candidate;
+      candidate = candidate->left;
+    }
   }
-  CopyUnder(&(*target)->right, source->right);
-  if ((*target)->right) {
-    (*target)->right->parent = *target;
+  return result;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::Replace(TreeNode* node,
+                                             TreeNode* replacement) {
+  if (!node->parent) {
+    root_ = replacement;
   }
+  ReplaceInParent(node, replacement);
 }
-template<typename T>
-void BinarySearchTree<T>::UpdateBeginAndRbegin() {
-  TreeNode* begin_copy{begin_};
-  while (begin_ && begin_->right && begin_->right->value == begin_->value) {
-    begin_ = begin_->right;
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::ReplaceInParent(
+    TreeNode* node, TreeNode* replacement) {
+  TreeNode* parent{node->parent};
+  if (!parent) {
+    Detach(replacement);
+  } else if (parent->left == node) {
+    parent->EntangleLeft(replacement);
+  } else {
+    parent->EntangleRight(replacement);
   }
-  if (!begin_ || !begin_->left) {
-    begin_ = begin_copy;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::RotateLeft(TreeNode* node) {
+  TreeNode* pivot{node->right};
+  ReplaceInParent(node, pivot);
+  node->EntangleRight(pivot->left);
+  pivot->EntangleLeft(node);
+  UpdateSizeAndHeight(node);
+  UpdateSizeAndHeight(pivot);
+  return pivot;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::RotateRight(TreeNode* node) {
+  TreeNode* pivot{node->left};
+  ReplaceInParent(node, pivot);
+  node->EntangleLeft(pivot->right);
+  pivot->EntangleRight(node);
+  UpdateSizeAndHeight(node);
+  UpdateSizeAndHeight(pivot);
+  return pivot;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::Rebalance(TreeNode* node) {
+  UpdateSizeAndHeight(node);
+  if constexpr (Balancing == TreeBalancing::kAvl) {
+    int balance{Height(node->left) - Height(node->right)};
+    if (balance > 1) {
+      if (Height(node->left->left) < Height(node->left->right)) {
+        RotateLeft(node->left);
+      }
+      return RotateRight(node);
+    }
+    if (balance < -1) {
+      if (Height(node->right->right) < Height(node->right->left)) {
+        RotateRight(node->right);
+      }
+      return RotateLeft(node);
+    }
   }
-  while (begin_ && begin_->left) {
-    begin_ = begin_->left;
+  return node;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::Retrace(TreeNode* node) {
+  for (; node; node = node->parent) {
+    int old_height{node->height};
+    node = Rebalance(node);
+    if (!node->parent) {
+      root_ = node;
+    }
+    // The heights above depend on this subtree only through its height.
+    if (node->height == old_height) {
+      break;
+    }
   }
-  while (rbegin_ && rbegin_->right) {
-    rbegin_ = rbegin_->right;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::RetraceToRoot(TreeNode* node) {
+  while (true) {
+    node = Rebalance(node);
+    if (!node->parent) {
+      return node;
+    }
+    node = node->parent;
   }
 }
-template<typename T>
-void BinarySearchTree<T>::erase(BinarySearchTree::ConstIterator iter) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::erase(
+    BinarySearchTree::ConstIterator iter) {
   if (iter == end()) {
     return;
   }
   --size_;
-  TreeNode* node_to_delete{iter.ptr_};
-  if (node_to_delete == begin_) {
-    begin_ = (++begin()).ptr_;
-  }
-  if (node_to_delete == rbegin_) {
-    rbegin_ = (--ConstIterator(rbegin_, this)).ptr_;
-  }
-  if (node_to_delete == root_) {
-    root_ = nullptr;
+  TreeNode* node{iter.ptr_};
+  if (node == begin_) {
+    begin_ = node->Next();
   }
-  node_to_delete->ReleaseParent();
-  if (node_to_delete->left) {
-    ReturnToTree(node_to_delete->left);
+  if (node == rbegin_) {
+    rbegin_ = node->Previous();
   }
-  if (node_to_delete->right) {
-    ReturnToTree(node_to_delete->right);
+  TreeNode* retrace_from;
+  if (!node->left || !node->right) {
+    retrace_from = node->parent;
+    Replace(node, node->left ? node->left : node->right);
+  } else {
+    TreeNode* successor{node->right->Leftmost()};
+    if (successor->parent == node) {
+      retrace_from = successor;
+    } else {
+      retrace_from = successor->parent;
+      Replace(successor, successor->right);
+      successor->EntangleRight(node->right);
+    }
+    Replace(node, successor);
+    successor->EntangleLeft(node->left);
+    // Retrace compares against the height the node had in this place.
+    successor->size = node->size;
+    successor->height = node->height;
   }
-  delete node_to_delete;
+  pool_.Delete(node);
+  AddToSizes(retrace_from, -1);
+  Retrace(retrace_from);
 }
-template<typename T>
-void BinarySearchTree<T>::ReturnToTree(TreeNode* node) {
-  node->ReleaseParent();
-  --size_;
-  insert(node);
-}
-template<typename T>
-void BinarySearchTree<T>::insert(BinarySearchTree::TreeNode* node) {
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::insert(
+    BinarySearchTree::TreeNode* node) {
   ++size_;
   if (!root_) {
     root_ = node;
     begin_ = node;
     rbegin_ = node;
-    UpdateBeginAndRbegin();
     return;
   }
-  ConstIterator iter{find(node->value)};
-  if (iter != end()) {
-    TreeNode* same_node{iter.ptr_};
-    if (same_node->parent) {
-      if (same_node->parent->right == same_node) {
-        same_node->parent->EntangleRight(node);
-      } else {
-        same_node->parent->EntangleLeft(node);
+  TreeNode* candidate{root_};
+  while (true) {
+    INSTRUMENT_COUNT(kTreeLevels, 1);
+    INSTRUMENT_COUNT(kComparisons, 1);
+    if (node->value < candidate->value) {
+      if (candidate->left) {
+        candidate = candidate->left;
+        continue;
       }
+      candidate->EntangleLeft(node);
+      if (candidate == begin_) {
+        begin_ = node;
+      }
+      break;
     }
-    node->EntangleLeft(same_node->left);
-    same_node->left = nullptr;
-    node->EntangleRight(same_node);
-    if (same_node == root_) {
-      root_ = node;
-    }
-    if (same_node == begin_) {
-      begin_ = node;
+    if (candidate->right) {
+      candidate = candidate->right;
+      continue;
     }
-    if (same_node == rbegin_) {
+    candidate->EntangleRight(node);
+    if (candidate == rbegin_) {
       rbegin_ = node;
     }
-  } else {
-    TreeNode* candidate{root_};
-    while (true) {
-      if (candidate->value < node->value) {
-        if (candidate->right) {
-          candidate = candidate->right;
-          continue;
-        }
-        candidate->EntangleRight(node);
-        break;
-      } else {
-        if (candidate->left) {
-          candidate = candidate->left;
-          continue;
-        }
-        candidate->EntangleLeft(node);
-        break;
+    break;
+  }
+  AddToSizes(candidate, 1);
+  Retrace(candidate);
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::ConstIterator
+BinarySearchTree<T, Balancing, Allocator>::nth(int k) const {
+  if (k < 0 || k >= size_) {
+    return end();
+  }
+  TreeNode* node{root_};
+  while (Size(node->left) != k) {
+    if (k < Size(node->left)) {
+      node = node->left;
+    } else {
+      k -= Size(node->left) + 1;
+      node = node->right;
+    }
+  }
+  return ConstIterator(node, this);
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+template<bool kOrEqual>
+int BinarySearchTree<T, Balancing, Allocator>::CountBelow(
+    const T& value) const {
+  int result{0};
+  for (TreeNode* node{root_}; node;) {
+    if (kOrEqual ? !(value < node->value) : node->value < value) {
+      result += Size(node->left) + 1;
+      node = node->right;
+    } else {
+      node = node->left;
+    }
+  }
+  return result;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+template<std::input_iterator Iterator>
+void BinarySearchTree<T, Balancing, Allocator>::insert_range(Iterator first,
+                                                             Iterator last) {
+  std::vector<T> values(first, last);
+  // Rebuilding pays off once inserting one by one would cost more.
+  size_t total{values.size() + size_};
+  if (!std::is_sorted(values.begin(), values.end()) ||
+      values.size() * std::bit_width(total) < size_t(size_)) {
+    for (T& value : values) {
+      insert(std::move(value));
+    }
+    return;
+  }
+  if (!empty()) {
+    // On ties the values already in the tree go first.
+    std::vector<T> merged;
+    merged.reserve(total);
+    auto next{values.begin()};
+    for (TreeNode* node{begin_}; node; node = node->Next()) {
+      for (; next != values.end() && *next < node->value; ++next) {
+        merged.push_back(std::move(*next));
+      }
+      merged.push_back(std::move(node->value));
+    }
+    std::move(next, values.end(), std::back_inserter(merged));
+    values = std::move(merged);
+    ReleaseMemoryAndReset();
+  }
+  BuildFrom(std::move(values));
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::BuildFrom(
+    std::vector<T>&& sorted) {
+  if (sorted.empty()) {
+    return;
+  }
+  std::vector<TreeNode*> nodes;
+  nodes.reserve(sorted.size());
+  pool_.Reserve(sorted.size());
+  for (T& value : sorted) {
+    nodes.push_back(pool_.New(std::move(value)));
+  }
+  root_ = Link(nodes.data(), static_cast<int>(nodes.size()));
+  root_->parent = nullptr;
+  size_ = root_->size;
+  begin_ = nodes.front();
+  rbegin_ = nodes.back();
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::Link(TreeNode* const* nodes,
+                                                int count) {
+  if (count == 0) {
+    return nullptr;
+  }
+  int middle{count / 2};
+  TreeNode* root{nodes[middle]};
+  root->EntangleLeft(Link(nodes, middle));
+  root->EntangleRight(Link(nodes + middle + 1, count - middle - 1));
+  UpdateSizeAndHeight(root);
+  return root;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::Join(TreeNode* left,
+                                                TreeNode* middle,
+                                                TreeNode* right) {
+  if constexpr (Balancing == TreeBalancing::kAvl) {
+    // The middle node goes down the spine of the taller tree to the
+    // first subtree that is about as tall as the other tree.
+    if (Height(left) > Height(right) + 1) {
+      TreeNode* parent{nullptr};
+      TreeNode* spine{left};
+      while (Height(spine) > Height(right) + 1) {
+        parent = spine;
+        spine = spine->right;
       }
+      middle->EntangleLeft(spine);
+      middle->EntangleRight(right);
+      parent->EntangleRight(middle);
+      return RetraceToRoot(middle);
+    }
+    if (Height(right) > Height(left) + 1) {
+      TreeNode* parent{nullptr};
+      TreeNode* spine{right};
+      while (Height(spine) > Height(left) + 1) {
+        parent = spine;
+        spine = spine->left;
+      }
+      middle->EntangleLeft(left);
+      middle->EntangleRight(spine);
+      parent->EntangleLeft(middle);
+      return RetraceToRoot(middle);
+    }
+  }
+  middle->EntangleLeft(left);
+  middle->EntangleRight(right);
+  middle->parent = nullptr;
+  UpdateSizeAndHeight(middle);
+  return middle;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::Join(TreeNode* left,
+                                                TreeNode* right) {
+  if (!left || !right) {
+    return left ? left : right;
+  }
+  TreeNode* last{left->Rightmost()};
+  if (last == left) {
+    left = Detach(last->left);
+  } else {
+    last->parent->EntangleRight(last->left);
+    left = RetraceToRoot(last->parent);
+  }
+  return Join(left, last, right);
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+template<bool kOrEqual>
+std::pair<typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*,
+          typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*>
+BinarySearchTree<T, Balancing, Allocator>::Split(TreeNode* root,
+                                                 const T& key) {
+  if (!root) {
+    return {nullptr, nullptr};
+  }
+  TreeNode* left{Detach(root->left)};
+  TreeNode* right{Detach(root->right)};
+  if (kOrEqual ? !(key < root->value) : root->value < key) {
+    auto [less, rest] = Split<kOrEqual>(right, key);
+    return {Join(left, root, less), rest};
+  }
+  auto [less, rest] = Split<kOrEqual>(left, key);
+  return {less, Join(rest, root, right)};
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+std::pair<typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*,
+          typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*>
+BinarySearchTree<T, Balancing, Allocator>::SplitAt(TreeNode* root,
+                                                   int count) {
+  if (!root) {
+    return {nullptr, nullptr};
+  }
+  int left_size{Size(root->left)};
+  TreeNode* left{Detach(root->left)};
+  TreeNode* right{Detach(root->right)};
+  if (left_size < count) {
+    auto [first, rest] = SplitAt(right, count - left_size - 1);
+    return {Join(left, root, first), rest};
+  }
+  auto [first, rest] = SplitAt(left, count);
+  return {first, Join(rest, root, right)};
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+template<typename BinarySearchTree<T, Balancing, Allocator>::SetOperation
+             kOperation>
+typename BinarySearchTree<T, Balancing, Allocator>::TreeNode*
+BinarySearchTree<T, Balancing, Allocator>::Combine(
+    TreeNode* lhs, TreeNode* rhs, std::vector<TreeNode*>& dropped) {
+  auto drop{[&dropped](TreeNode* subtree) {
+    if (subtree) {
+      dropped.push_back(subtree);
+    }
+  }};
+  if (!lhs || !rhs) {
+    if constexpr (kOperation == kMerge || kOperation == kUnion) {
+      return lhs ? lhs : rhs;
     }
+    drop(rhs);
+    if constexpr (kOperation == kIntersection) {
+      drop(lhs);
+      return nullptr;
+    }
+    return lhs;
+  }
+  // Both trees are cut around the values equal to the root of the larger
+  // one, which stays in place until the end.
+  const T& key{(Size(lhs) < Size(rhs) ? rhs : lhs)->value};
+  int total{Size(lhs) + Size(rhs)};
+  auto [lhs_less, lhs_rest] = Split<false>(lhs, key);
+  auto [lhs_equal, lhs_greater] = Split<true>(lhs_rest, key);
+  auto [rhs_less, rhs_rest] = Split<false>(rhs, key);
+  auto [rhs_equal, rhs_greater] = Split<true>(rhs_rest, key);
+  TreeNode* less;
+  TreeNode* greater;
+  concurrency::ThreadPool& pool{concurrency::ThreadPool::Default()};
+  if (total >= kParallelCutoff && pool.IsParallel()) {
+    std::vector<TreeNode*> less_dropped;
+    pool.Invoke(
+        [&] { less = Combine<kOperation>(lhs_less, rhs_less, less_dropped); },
+        [&] {
+          greater = Combine<kOperation>(lhs_greater, rhs_greater, dropped);
+        });
+    dropped.insert(dropped.end(), less_dropped.begin(), less_dropped.end());
+  } else {
+    less = Combine<kOperation>(lhs_less, rhs_less, dropped);
+    greater = Combine<kOperation>(lhs_greater, rhs_greater, dropped);
+  }
+  // Of m equal values here and n in other, the union keeps the m and the
+  // last n - m, the intersection the first of the m, and the difference
+  // the last m - n.
+  TreeNode* equal;
+  if constexpr (kOperation == kMerge) {
+    equal = Join(lhs_equal, rhs_equal);
+  } else if constexpr (kOperation == kUnion) {
+    auto [common, extra] = SplitAt(rhs_equal, Size(lhs_equal));
+    equal = Join(lhs_equal, extra);
+    drop(common);
+  } else {
+    auto [common, extra] = SplitAt(lhs_equal, Size(rhs_equal));
+    equal = kOperation == kIntersection ? common : extra;
+    drop(kOperation == kIntersection ? extra : common);
+    drop(rhs_equal);
+  }
+  return Join(Join(less, equal), greater);
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+template<typename BinarySearchTree<T, Balancing, Allocator>::SetOperation
+             kOperation>
+void BinarySearchTree<T, Balancing, Allocator>::Combine(
+    BinarySearchTree& other) {
+  // Only merge passes a reference, merging a tree into itself does nothing.
+  if (this == &other) {
+    return;
+  }
+  if (get_allocator() != other.get_allocator()) {
+    BinarySearchTree copy(other.begin(), other.end(), get_allocator());
+    other.clear();
+    Combine<kOperation>(copy);
+    return;
+  }
+  pool_.Adopt(std::move(other.pool_));
+  TreeNode* rhs{other.root_};
+  other.CopyFieldsFrom(BinarySearchTree());
+  std::vector<TreeNode*> dropped;
+  TreeNode* root{Combine<kOperation>(std::exchange(root_, nullptr), rhs,
+                                     dropped)};
+  for (TreeNode* subtree : dropped) {
+    CutPostOrder(subtree, [this](TreeNode* node) { pool_.Delete(node); });
+  }
+  ResetRoot(root);
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::ResetRoot(TreeNode* root) {
+  root_ = root;
+  size_ = Size(root);
+  begin_ = root ? root->Leftmost() : nullptr;
+  rbegin_ = root ? root->Rightmost() : nullptr;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>
+BinarySearchTree<T, Balancing, Allocator>::split(const T& key) {
+  BinarySearchTree result(get_allocator());
+  result.pool_ = pool_.Share();
+  auto [less, rest] = Split<false>(root_, key);
+  ResetRoot(less);
+  result.ResetRoot(rest);
+  return result;
+}
+template<typename T, TreeBalancing Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::join(BinarySearchTree other) {
+  if (!empty() && !other.empty() && other.begin_->value < rbegin_->value) {
+    throw std::logic_error("Joined values are out of order");
+  }
+  if (get_allocator() != other.get_allocator()) {
+    join(BinarySearchTree(other.begin(), other.end(), get_allocator()));
+    return;
   }
-  UpdateBeginAndRbegin();
+  pool_.Adopt(std::move(other.pool_));
+  TreeNode* rhs{other.root_};
+  other.CopyFieldsFrom(BinarySearchTree());
+  ResetRoot(Join(root_, rhs));
 }
 
 #endif  // BINARY_SEARCH_TREE_H_
@@ -0,0 +1,487 @@
+#ifndef CONCURRENT_QUEUE_H_
+#define CONCURRENT_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "epoch_reclamation.h"
+
+namespace concurrency {
+
+// Work queues for producers that would push to the back of a
+// BiDirectionalList and consumers that would pop from its front. The bulk
+// operations claim a run of slots or nodes with one atomic update.
+
+enum class QueueAccess {
+  // Any number of producers and consumers.
+  kMpmc,
+  // One producer thread and one consumer thread.
+  kSpsc,
+};
+
+// The move constructor of T must not throw, values are moved from the
+// slot a producer has claimed.
+template<typename T, QueueAccess Access = QueueAccess::kMpmc>
+class BoundedQueue {
+ private:
+  // A slot is free for the producer of ticket t when its sequence is t,
+  // and full for the consumer of ticket t when it is t + 1.
+  struct Cell {
+    T* Value() { return std::launder(reinterpret_cast<T*>(this->storage)); }
+
+    std::atomic<size_t> sequence;
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+ public:
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+
+  // The capacity is rounded up to a power of two.
+  explicit BoundedQueue(size_t capacity)
+      : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        cells_(new Cell[this->mask_ + 1]) {
+    for (size_t i{0}; i <= this->mask_; ++i) {
+      this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+  // Requires that no other thread uses the queue anymore.
+  ~BoundedQueue() {
+    while (this->TryPop()) {
+    }
+  }
+
+  [[nodiscard]] size_t Capacity() const { return this->mask_ + 1; }
+  // Exact only while no other thread uses the queue.
+  [[nodiscard]] size_t Size() const {
+    size_t pushed{this->push_ticket_.load(std::memory_order_relaxed)};
+    size_t popped{this->pop_ticket_.load(std::memory_order_relaxed)};
+    return pushed > popped ? pushed - popped : 0;
+  }
+
+  // Returns false when the queue is full.
+  bool TryPush(T value) {
+    auto [ticket, count] = this->Claim<true>(1);
+    if (count == 0) {
+      return false;
+    }
+    this->Fill(ticket, std::move(value));
+    return true;
+  }
+  [[nodiscard]] std::optional<T> TryPop() {
+    auto [ticket, count] = this->Claim<false>(1);
+    if (count == 0) {
+      return std::nullopt;
+    }
+    return this->Drain(ticket);
+  }
+  // Moves values from the front of the range for as many slots as are
+  // free, and returns how many it moved.
+  template<std::forward_iterator Iterator>
+  size_t PushBulk(Iterator first, Iterator last) {
+    auto [ticket, count] =
+        this->Claim<true>(static_cast<size_t>(std::distance(first, last)));
+    for (size_t i{0}; i < count; ++i, ++first) {
+      this->Fill(ticket + i, std::move(*first));
+    }
+    return count;
+  }
+  // Pops up to max_count values into the output and returns how many.
+  template<typename OutputIterator>
+  size_t PopBulk(OutputIterator output, size_t max_count) {
+    auto [ticket, count] = this->Claim<false>(max_count);
+    for (size_t i{0}; i < count; ++i) {
+      *output++ = this->Drain(ticket + i);
+    }
+    return count;
+  }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  // Takes up to count consecutive tickets whose slots are ready, for the
+  // producers or for the consumers. Returns the first ticket and how many
+  // were taken, none when the queue is full or empty.
+  template<bool kPush>
+  std::pair<size_t, size_t> Claim(size_t count) {
+    std::atomic<size_t>& next_ticket{kPush ? this->push_ticket_
+                                           : this->pop_ticket_};
+    size_t ticket{next_ticket.load(std::memory_order_relaxed)};
+    while (count > 0) {
+      size_t ready{0};
+      for (; ready < count; ++ready) {
+        size_t sequence{this->cells_[(ticket + ready) & this->mask_]
+                            .sequence.load(std::memory_order_acquire)};
+        if (sequence != ticket + ready + (kPush ? 0 : 1)) {
+          break;
+        }
+      }
+      if (ready == 0) {
+        size_t sequence{this->cells_[ticket & this->mask_].sequence.load(
+            std::memory_order_acquire)};
+        // A slot behind the ticket means a full or empty queue, one ahead
+        // means that the ticket is stale.
+        ptrdiff_t lag{
+            static_cast<ptrdiff_t>(sequence - ticket - (kPush ? 0 : 1))};
+        if (lag < 0) {
+          return {ticket, 0};
+        }
+        ticket = next_ticket.load(std::memory_order_relaxed);
+        continue;
+      }
+      if (next_ticket.compare_exchange_weak(ticket, ticket + ready,
+                                            std::memory_order_relaxed)) {
+        return {ticket, ready};
+      }
+    }
+    return {ticket, 0};
+  }
+  void Fill(size_t ticket, T&& value) {
+    Cell& cell{this->cells_[ticket & this->mask_]};
+    std::construct_at(cell.Value(), std::move(value));
+    cell.sequence.store(ticket + 1, std::memory_order_release);
+  }
+  T Drain(size_t ticket) {
+    Cell& cell{this->cells_[ticket & this->mask_]};
+    T value{std::move(*cell.Value())};
+    std::destroy_at(cell.Value());
+    cell.sequence.store(ticket + this->mask_ + 1, std::memory_order_release);
+    return value;
+  }
+
+  const size_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  alignas(kCacheLine) std::atomic<size_t> push_ticket_{0};
+  alignas(kCacheLine) std::atomic<size_t> pop_ticket_{0};
+};
+
+// Ring buffer between two threads. Each side keeps the last index it has
+// seen of the other side and reloads it only when the queue looks full or
+// empty, so most operations touch no shared cache line but the slot.
+template<typename T>
+class BoundedQueue<T, QueueAccess::kSpsc> {
+ public:
+  static_assert(std::is_nothrow_move_constructible_v<T>);
+
+  // The capacity is rounded up to a power of two.
+  explicit BoundedQueue(size_t capacity)
+      : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+        slots_(std::allocator<Slot>().allocate(this->mask_ + 1)) {}
+  BoundedQueue(const BoundedQueue&) = delete;
+  BoundedQueue& operator=(const BoundedQueue&) = delete;
+  // Requires that neither thread uses the queue anymore.
+  ~BoundedQueue() {
+    while (this->TryPop()) {
+    }
+    std::allocator<Slot>().deallocate(this->slots_, this->mask_ + 1);
+  }
+
+  [[nodiscard]] size_t Capacity() const { return this->mask_ + 1; }
+  // Exact only while neither thread changes the queue.
+  [[nodiscard]] size_t Size() const {
+    return this->tail_.load(std::memory_order_acquire) -
+           this->head_.load(std::memory_order_acquire);
+  }
+
+  // The producer side.
+  bool TryPush(T value) {
+    size_t tail{this->tail_.load(std::memory_order_relaxed)};
+    if (this->PushRoom(tail, 1) == 0) {
+      return false;
+    }
+    std::construct_at(this->At(tail), std::move(value));
+    this->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+  template<std::forward_iterator Iterator>
+  size_t PushBulk(Iterator first, Iterator last) {
+    size_t tail{this->tail_.load(std::memory_order_relaxed)};
+    size_t count{this->PushRoom(
+        tail, static_cast<size_t>(std::distance(first, last)))};
+    for (size_t i{0}; i < count; ++i, ++first) {
+      std::construct_at(this->At(tail + i), std::move(*first));
+    }
+    this->tail_.store(tail + count, std::memory_order_release);
+    return count;
+  }
+
+  // The consumer side.
+  [[nodiscard]] std::optional<T> TryPop() {
+    size_t head{this->head_.load(std::memory_order_relaxed)};
+    if (this->PopRoom(head, 1) == 0) {
+      return std::nullopt;
+    }
+    std::optional<T> result{this->Take(head)};
+    this->head_.store(head + 1, std::memory_order_release);
+    return result;
+  }
+  template<typename OutputIterator>
+  size_t PopBulk(OutputIterator output, size_t max_count) {
+    size_t head{this->head_.load(std::memory_order_relaxed)};
+    size_t count{this->PopRoom(head, max_count)};
+    for (size_t i{0}; i < count; ++i) {
+      *output++ = this->Take(head + i);
+    }
+    this->head_.store(head + count, std::memory_order_release);
+    return count;
+  }
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  struct Slot {
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+  T* At(size_t index) {
+    return std::launder(
+        reinterpret_cast<T*>(this->slots_[index & this->mask_].storage));
+  }
+  T Take(size_t index) {
+    T value{std::move(*this->At(index))};
+    std::destroy_at(this->At(index));
+    return value;
+  }
+  // The number of slots up to count that are free or full.
+  size_t PushRoom(size_t tail, size_t count) {
+    if (this->Capacity() - (tail - this->cached_head_) < count) {
+      this->cached_head_ = this->head_.load(std::memory_order_acquire);
+    }
+    return std::min(count, this->Capacity() - (tail - this->cached_head_));
+  }
+  size_t PopRoom(size_t head, size_t count) {
+    if (this->cached_tail_ - head < count) {
+      this->cached_tail_ = this->tail_.load(std::memory_order_acquire);
+    }
+    return std::min(count, this->cached_tail_ - head);
+  }
+
+  const size_t mask_;
+  Slot* slots_;
+  // Written by the consumer.
+  alignas(kCacheLine) std::atomic<size_t> head_{0};
+  size_t cached_tail_{0};
+  // Written by the producer.
+  alignas(kCacheLine) std::atomic<size_t> tail_{0};
+  size_t cached_head_{0};
+};
+
+// Unbounded Michael-Scott queue. The head is a dummy node whose successor
+// holds the first value. Popped nodes are retired through the default
+// EpochDomain and then recycled by all queues of the same type, up to
+// kMaxRecycledNodes of them.
+template<typename T>
+class LinkedQueue {
+ private:
+  struct Node {
+    T* Value() { return std::launder(reinterpret_cast<T*>(this->storage)); }
+
+    std::atomic<Node*> next{nullptr};
+    alignas(T) std::byte storage[sizeof(T)];
+  };
+
+ public:
+  static constexpr int kMaxRecycledNodes = 1 << 16;
+
+  LinkedQueue() {
+    EpochDomain::Guard guard;
+    Node* dummy{NewNode()};
+    this->head_.store(dummy, std::memory_order_relaxed);
+    this->tail_.store(dummy, std::memory_order_relaxed);
+  }
+  LinkedQueue(const LinkedQueue&) = delete;
+  LinkedQueue& operator=(const LinkedQueue&) = delete;
+  // Requires that no other thread uses the queue anymore.
+  ~LinkedQueue();
+
+  // Exact only while no other thread uses the queue.
+  [[nodiscard]] bool IsEmpty() const {
+    EpochDomain::Guard guard;
+    return !this->head_.load(std::memory_order_acquire)
+                ->next.load(std::memory_order_acquire);
+  }
+
+  // Never fails, the queue is unbounded.
+  void Push(T value) {
+    EpochDomain::Guard guard;
+    Node* node{NewNode()};
+    std::construct_at(node->Value(), std::move(value));
+    this->Link(node, node);
+  }
+  [[nodiscard]] std::optional<T> TryPop() {
+    std::optional<T> result;
+    this->PopBulk(&result, 1);
+    return result;
+  }
+  // Links all values of the range, moved from it, with one update of the
+  // shared list.
+  template<std::input_iterator Iterator>
+  void PushBulk(Iterator first, Iterator last);
+  // Pops up to max_count values into the output and returns how many.
+  template<typename OutputIterator>
+  size_t PopBulk(OutputIterator output, size_t max_count);
+
+ private:
+  static constexpr size_t kCacheLine = 64;
+
+  // Requires the calling thread to be pinned, which keeps a node from
+  // coming back to the free list while another thread is taking it.
+  static Node* NewNode() {
+    Node* node{free_nodes_.load(std::memory_order_acquire)};
+    while (node && !free_nodes_.compare_exchange_weak(
+                       node, node->next.load(std::memory_order_relaxed),
+                       std::memory_order_acquire)) {
+    }
+    if (!node) {
+      return new Node;
+    }
+    free_node_count_.fetch_sub(1, std::memory_order_relaxed);
+    node->next.store(nullptr, std::memory_order_relaxed);
+    return node;
+  }
+  // The deleter of retired nodes.
+  static void Recycle(void* object) {
+    auto* node{static_cast<Node*>(object)};
+    if (free_node_count_.fetch_add(1, std::memory_order_relaxed) >=
+        kMaxRecycledNodes) {
+      free_node_count_.fetch_sub(1, std::memory_order_relaxed);
+      delete node;
+      return;
+    }
+    Node* top{free_nodes_.load(std::memory_order_relaxed)};
+    do {
+      node->next.store(top, std::memory_order_relaxed);
+    } while (!free_nodes_.compare_exchange_weak(top, node,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed));
+  }
+  // Appends the chain of new nodes from first to last.
+  void Link(Node* first, Node* last);
+
+  alignas(kCacheLine) std::atomic<Node*> head_;
+  alignas(kCacheLine) std::atomic<Node*> tail_;
+
+  static inline std::atomic<Node*> free_nodes_{nullptr};
+  static inline std::atomic<int> free_node_count_{0};
+};
+template<typename T>
+LinkedQueue<T>::~LinkedQueue() {
+  Node* node{this->head_.load(std::memory_order_relaxed)};
+  bool is_dummy{true};
+  while (node) {
+    Node* next{node->next.load(std::memory_order_relaxed)};
+    if (!is_dummy) {
+      std::destroy_at(node->Value());
+    }
+    EpochDomain::Default().Retire(node, &Recycle);
+    node = next;
+    is_dummy = false;
+  }
+}
+template<typename T>
+template<std::input_iterator Iterator>
+void LinkedQueue<T>::PushBulk(Iterator first, Iterator last) {
+  if (first == last) {
+    return;
+  }
+  EpochDomain::Guard guard;
+  Node* chain{NewNode()};
+  std::construct_at(chain->Value(), std::move(*first));
+  Node* chain_last{chain};
+  for (++first; first != last; ++first) {
+    Node* node{NewNode()};
+    std::construct_at(node->Value(), std::move(*first));
+    chain_last->next.store(node, std::memory_order_relaxed);
+    chain_last = node;
+  }
+  this->Link(chain, chain_last);
+}
+template<typename T>
+void LinkedQueue<T>::Link(Node* first, Node* last) {
+  while (true) {
+    Node* tail{this->tail_.load(std::memory_order_acquire)};
+    Node* next{tail->next.load(std::memory_order_acquire)};
+    if (tail != this->tail_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (next) {
+      // Helps the push that linked next but has not moved the tail yet.
+      this->tail_.compare_exchange_weak(tail, next, std::memory_order_release,
+                                        std::memory_order_relaxed);
+      continue;
+    }
+    if (tail->next.compare_exchange_weak(next, first,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+      this->tail_.compare_exchange_strong(tail, last,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed);
+      return;
+    }
+  }
+}
+template<typename T>
+template<typename OutputIterator>
+size_t LinkedQueue<T>::PopBulk(OutputIterator output, size_t max_count) {
+  if (max_count == 0) {
+    return 0;
+  }
+  EpochDomain::Guard guard;
+  while (true) {
+    Node* head{this->head_.load(std::memory_order_acquire)};
+    // The last of the popped nodes becomes the new dummy.
+    Node* last{head};
+    size_t count{0};
+    for (Node* next; count < max_count &&
+                     (next = last->next.load(std::memory_order_acquire));
+         ++count) {
+      last = next;
+    }
+    if (head != this->head_.load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (count == 0) {
+      return 0;
+    }
+    // The tail must not stay behind on a node that is about to be retired.
+    Node* tail{this->tail_.load(std::memory_order_acquire)};
+    bool is_tail_behind{false};
+    for (Node* node{head}; node != last;
+         node = node->next.load(std::memory_order_acquire)) {
+      is_tail_behind |= node == tail;
+    }
+    if (is_tail_behind) {
+      this->tail_.compare_exchange_weak(tail, last, std::memory_order_release,
+                                        std::memory_order_relaxed);
+      continue;
+    }
+    // Releases the links read above to the consumer that starts from last.
+    if (!this->head_.compare_exchange_weak(head, last,
+                                           std::memory_order_acq_rel,
+                                           std::memory_order_relaxed)) {
+      continue;
+    }
+    // The popped values now belong to this thread alone.
+    for (Node* node{head}; node != last;) {
+      Node* next{node->next.load(std::memory_order_relaxed)};
+      *output++ = std::move(*next->Value());
+      std::destroy_at(next->Value());
+      EpochDomain::Default().Retire(node, &Recycle);
+      node = next;
+    }
+    return count;
+  }
+}
+
+}  // namespace concurrency
+
+#endif  // CONCURRENT_QUEUE_H_
@@ -0,0 +1,317 @@
+#ifndef CONCURRENT_SKIP_LIST_H_
+#define CONCURRENT_SKIP_LIST_H_
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "epoch_reclamation.h"
+
+namespace concurrency {
+
+// Sorted multiset that any number of threads may use at once, with the
+// find, contains, insert and erase of BinarySearchTree. It is a lazy skip
+// list: lookups never lock or write shared memory, while insert and erase
+// lock only the nodes in front of the one they link or unlink. Erased
+// nodes are reclaimed through the default EpochDomain.
+//
+// Equal values are told apart by the order of their insertion, which
+// keeps every node key unique and preserves that order as in
+// BinarySearchTree.
+template<typename T>
+class ConcurrentSkipList {
+ private:
+  static constexpr int kMaxHeight = 32;
+
+  struct Node;
+  struct Tower {
+    explicit Tower(int height) : height(height) {}
+
+    void Lock() {
+      while (locked.exchange(true, std::memory_order_acquire)) {
+        while (locked.load(std::memory_order_relaxed)) {
+          std::this_thread::yield();
+        }
+      }
+    }
+    void Unlock() { locked.store(false, std::memory_order_release); }
+
+    int height;
+    std::atomic<bool> locked{false};
+    // Set by the erase that owns the node, before it is unlinked.
+    std::atomic<bool> marked{false};
+    // Set once the node is linked on all its levels.
+    std::atomic<bool> fully_linked{false};
+    std::atomic<Node*>* next{nullptr};
+  };
+  struct Head : Tower {
+    Head() : Tower(kMaxHeight) {
+      this->next = links;
+      this->fully_linked.store(true, std::memory_order_relaxed);
+    }
+
+    std::atomic<Node*> links[kMaxHeight]{};
+  };
+  // The links of a node follow it in the same allocation.
+  struct Node : Tower {
+    template<typename... Ts>
+    Node(int height, uint64_t sequence, Ts&&... args)
+        : Tower(height),
+          value(std::forward<Ts>(args)...),
+          sequence(sequence) {}
+
+    T value;
+    uint64_t sequence;
+  };
+
+ public:
+  ConcurrentSkipList() = default;
+  ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+  ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+  // Requires that no other thread uses the list anymore.
+  ~ConcurrentSkipList();
+
+  // Exact only while no other thread modifies the list.
+  [[nodiscard]] int size() const {
+    return size_.load(std::memory_order_relaxed);
+  }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  [[nodiscard]] bool contains(const T& value) const {
+    EpochDomain::Guard guard;
+    return FirstLive(value) != nullptr;
+  }
+  // A copy of the first of the equal values, if any.
+  [[nodiscard]] std::optional<T> find(const T& value) const {
+    EpochDomain::Guard guard;
+    Node* node{FirstLive(value)};
+    return node ? std::optional<T>(node->value) : std::nullopt;
+  }
+
+  template<typename U>
+  void insert(U&& value) { Insert(NewNode(std::forward<U>(value))); }
+  template<typename... Ts>
+  void emplace(Ts&&... args) { Insert(NewNode(std::forward<Ts>(args)...)); }
+  // Erases the first of the equal values, returns whether there was one.
+  bool erase(const T& value);
+
+  // Calls function(value) for the values in sorted order. Every value that
+  // is in the list for the whole call is visited once, values inserted or
+  // erased meanwhile may or may not be.
+  template<typename Function>
+  void ForEach(Function&& function) const;
+  [[nodiscard]] std::vector<T> to_vector() const;
+
+ private:
+  template<typename... Ts>
+  Node* NewNode(Ts&&... args);
+  static void DeleteNode(void* node);
+  // A geometric height with ratio 1/2.
+  static int RandomHeight();
+
+  static bool IsBefore(const Node* node, const T& value, uint64_t sequence) {
+    return node->value < value ||
+           (!(value < node->value) && node->sequence < sequence);
+  }
+  // Fills the nodes in front of the key and behind it on every level.
+  void Find(const T& value, uint64_t sequence, Tower** preds,
+            Node** succs) const;
+  // The first of the equal values that is neither being linked nor erased.
+  [[nodiscard]] Node* FirstLive(const T& value) const;
+  // Locks the distinct preds of the levels below height and checks that
+  // each of them still links to the succ of its level. On failure nothing
+  // stays locked.
+  static bool LockAndValidate(Tower** preds, Node** succs, int height);
+  static void UnlockPreds(Tower** preds, int height);
+  void Insert(Node*);
+
+  mutable Head head_;
+  std::atomic<int> size_{0};
+  std::atomic<uint64_t> next_sequence_{0};
+};
+template<typename T>
+ConcurrentSkipList<T>::~ConcurrentSkipList() {
+  Node* node{head_.next[0].load(std::memory_order_acquire)};
+  while (node) {
+    Node* next{node->next[0].load(std::memory_order_relaxed)};
+    DeleteNode(node);
+    node = next;
+  }
+}
+template<typename T>
+bool ConcurrentSkipList<T>::erase(const T& value) {
+  EpochDomain::Guard guard;
+  Node* victim;
+  while (true) {
+    victim = FirstLive(value);
+    if (!victim) {
+      return false;
+    }
+    victim->Lock();
+    if (!victim->marked.load(std::memory_order_relaxed)) {
+      break;
+    }
+    victim->Unlock();
+  }
+  victim->marked.store(true, std::memory_order_release);
+  Tower* preds[kMaxHeight];
+  Node* succs[kMaxHeight];
+  do {
+    Find(victim->value, victim->sequence, preds, succs);
+  } while (!LockAndValidate(preds, succs, victim->height));
+  for (int level{victim->height - 1}; level >= 0; --level) {
+    preds[level]->next[level].store(
+        victim->next[level].load(std::memory_order_relaxed),
+        std::memory_order_release);
+  }
+  UnlockPreds(preds, victim->height);
+  victim->Unlock();
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  EpochDomain::Default().Retire(victim, &DeleteNode);
+  return true;
+}
+template<typename T>
+template<typename Function>
+void ConcurrentSkipList<T>::ForEach(Function&& function) const {
+  EpochDomain::Guard guard;
+  for (Node* node{head_.next[0].load(std::memory_order_acquire)}; node;
+       node = node->next[0].load(std::memory_order_acquire)) {
+    if (node->fully_linked.load(std::memory_order_acquire) &&
+        !node->marked.load(std::memory_order_acquire)) {
+      function(node->value);
+    }
+  }
+}
+template<typename T>
+std::vector<T> ConcurrentSkipList<T>::to_vector() const {
+  std::vector<T> result;
+  result.reserve(size());
+  ForEach([&result](const T& value) { result.push_back(value); });
+  return result;
+}
+template<typename T>
+template<typename... Ts>
+typename ConcurrentSkipList<T>::Node* ConcurrentSkipList<T>::NewNode(
+    Ts&&... args) {
+  int height{RandomHeight()};
+  void* memory{::operator new(sizeof(Node) +
+                              height * sizeof(std::atomic<Node*>))};
+  Node* node;
+  try {
+    node = ::new (memory) Node(
+        height, next_sequence_.fetch_add(1, std::memory_order_relaxed),
+        std::forward<Ts>(args)...);
+  } catch (...) {
+    ::operator delete(memory);
+    throw;
+  }
+  node->next = reinterpret_cast<std::atomic<Node*>*>(
+      static_cast<std::byte*>(memory) + sizeof(Node));
+  for (int level{0}; level < height; ++level) {
+    ::new (&node->next[level]) std::atomic<Node*>(nullptr);
+  }
+  return node;
+}
+template<typename T>
+void ConcurrentSkipList<T>::DeleteNode(void* node) {
+  std::destroy_at(static_cast<Node*>(node));
+  ::operator delete(node);
+}
+template<typename T>
+int ConcurrentSkipList<T>::RandomHeight() {
+  thread_local uint64_t state{
+      0x9E3779B97F4A7C15u ^
+      reinterpret_cast<uintptr_t>(&state)};
+  // xorshift64
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return std::min(kMaxHeight, 1 + std::countr_zero(state));
+}
+template<typename T>
+void ConcurrentSkipList<T>::Find(const T& value, uint64_t sequence,
+                                 Tower** preds, Node** succs) const {
+  Tower* pred{&head_};
+  for (int level{kMaxHeight - 1}; level >= 0; --level) {
+    Node* current{pred->next[level].load(std::memory_order_acquire)};
+    while (current && IsBefore(current, value, sequence)) {
+      pred = current;
+      current = pred->next[level].load(std::memory_order_acquire);
+    }
+    preds[level] = pred;
+    succs[level] = current;
+  }
+}
+template<typename T>
+typename ConcurrentSkipList<T>::Node* ConcurrentSkipList<T>::FirstLive(
+    const T& value) const {
+  const Tower* pred{&head_};
+  Node* current{nullptr};
+  for (int level{kMaxHeight - 1}; level >= 0; --level) {
+    current = pred->next[level].load(std::memory_order_acquire);
+    while (current && current->value < value) {
+      pred = current;
+      current = pred->next[level].load(std::memory_order_acquire);
+    }
+  }
+  for (; current && !(value < current->value);
+       current = current->next[0].load(std::memory_order_acquire)) {
+    if (current->fully_linked.load(std::memory_order_acquire) &&
+        !current->marked.load(std::memory_order_acquire)) {
+      return current;
+    }
+  }
+  return nullptr;
+}
+template<typename T>
+bool ConcurrentSkipList<T>::LockAndValidate(Tower** preds, Node** succs,
+                                            int height) {
+  for (int level{0}; level < height; ++level) {
+    Tower* pred{preds[level]};
+    Node* succ{succs[level]};
+    if (level == 0 || pred != preds[level - 1]) {
+      pred->Lock();
+    }
+    if (pred->marked.load(std::memory_order_acquire) ||
+        pred->next[level].load(std::memory_order_acquire) != succ) {
+      UnlockPreds(preds, level + 1);
+      return false;
+    }
+  }
+  return true;
+}
+template<typename T>
+void ConcurrentSkipList<T>::UnlockPreds(Tower** preds, int height) {
+  for (int level{0}; level < height; ++level) {
+    if (level == 0 || preds[level] != preds[level - 1]) {
+      preds[level]->Unlock();
+    }
+  }
+}
+template<typename T>
+void ConcurrentSkipList<T>::Insert(Node* node) {
+  EpochDomain::Guard guard;
+  Tower* preds[kMaxHeight];
+  Node* succs[kMaxHeight];
+  do {
+    Find(node->value, node->sequence, preds, succs);
+  } while (!LockAndValidate(preds, succs, node->height));
+  for (int level{0}; level < node->height; ++level) {
+    node->next[level].store(succs[level], std::memory_order_relaxed);
+    preds[level]->next[level].store(node, std::memory_order_release);
+  }
+  node->fully_linked.store(true, std::memory_order_release);
+  UnlockPreds(preds, node->height);
+  size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace concurrency
+
+#endif  // CONCURRENT_SKIP_LIST_H_
@@ -0,0 +1,185 @@
+#ifndef EPOCH_RECLAMATION_H_
+#define EPOCH_RECLAMATION_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace concurrency {
+
+// Epoch-based reclamation for structures with lock-free readers. A thread
+// holds an EpochDomain::Guard while it touches shared nodes, and a node that
+// has been unlinked is retired instead of deleted. The global epoch advances
+// once every pinned thread has seen the current one, and a node is deleted
+// two advances after its retirement, when no thread can still reach it.
+class EpochDomain {
+ private:
+  struct Participant;
+
+ public:
+  // Pins the calling thread. Guards nest.
+  class Guard {
+   public:
+    Guard() : participant_(Default().CurrentParticipant()) {
+      if (this->participant_.nesting++ == 0) {
+        this->participant_.epoch.store(
+            Default().epoch_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+      }
+    }
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+    ~Guard() {
+      if (--this->participant_.nesting == 0) {
+        this->participant_.epoch.store(kInactive, std::memory_order_release);
+      }
+    }
+
+   private:
+    Participant& participant_;
+  };
+
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  // The domain is never destroyed, so threads may use it until they exit.
+  static EpochDomain& Default() {
+    static EpochDomain* domain{new EpochDomain};
+    return *domain;
+  }
+
+  // Calls deleter(object) once no thread pinned now can reach the object,
+  // which must already be unreachable for threads that pin later.
+  void Retire(void* object, void (*deleter)(void*)) {
+    Participant& participant{this->CurrentParticipant()};
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    participant.limbo.push_back(
+        {object, deleter, this->epoch_.load(std::memory_order_relaxed)});
+    if (participant.limbo.size() >= participant.collect_at) {
+      this->Reclaim(participant, 1);
+    }
+  }
+  // Advances the epoch as far as the pinned threads allow and deletes what
+  // the calling thread and exited threads have retired long enough ago,
+  // for threads that retire too rarely to wait for the next collection in
+  // Retire. Walks all participants. Called while no thread is pinned, it
+  // deletes everything the calling thread has retired.
+  void TryCollect() {
+    this->Reclaim(this->CurrentParticipant(), 2);
+  }
+
+ private:
+  static constexpr uint64_t kInactive = UINT64_MAX;
+  // Retirements between two attempts to advance the epoch.
+  static constexpr size_t kCollectInterval = 64;
+
+  struct Retired {
+    void* object;
+    void (*deleter)(void*);
+    uint64_t epoch;
+  };
+  struct alignas(64) Participant {
+    // The epoch the thread is pinned in, or kInactive.
+    std::atomic<uint64_t> epoch{kInactive};
+    std::atomic<bool> in_use{true};
+    Participant* next{nullptr};
+    // The rest belongs to the thread using the participant.
+    int nesting{0};
+    std::vector<Retired> limbo;
+    size_t collect_at{kCollectInterval};
+  };
+  // Hands the participant of a thread back when the thread exits, together
+  // with the objects it has not deleted yet.
+  struct ThreadRecord {
+    ~ThreadRecord() {
+      {
+        std::lock_guard<std::mutex> lock(this->domain->orphans_mutex_);
+        this->domain->orphans_.insert(this->domain->orphans_.end(),
+                                      this->participant->limbo.begin(),
+                                      this->participant->limbo.end());
+      }
+      this->participant->limbo.clear();
+      this->participant->collect_at = kCollectInterval;
+      this->participant->in_use.store(false, std::memory_order_release);
+    }
+
+    EpochDomain* domain;
+    Participant* participant;
+  };
+
+  EpochDomain() = default;
+
+  Participant& CurrentParticipant() {
+    thread_local ThreadRecord record{this, this->Acquire()};
+    return *record.participant;
+  }
+  // Reuses the participant of an exited thread if there is one.
+  Participant* Acquire() {
+    Participant* head{this->participants_.load(std::memory_order_acquire)};
+    for (Participant* participant{head}; participant;
+         participant = participant->next) {
+      bool expected{false};
+      if (participant->in_use.compare_exchange_strong(
+              expected, true, std::memory_order_acquire)) {
+        return participant;
+      }
+    }
+    auto* participant{new Participant};
+    participant->next = head;
+    while (!this->participants_.compare_exchange_weak(
+        participant->next, participant, std::memory_order_acq_rel)) {
+    }
+    return participant;
+  }
+  void TryAdvance() {
+    uint64_t epoch{this->epoch_.load(std::memory_order_seq_cst)};
+    for (Participant* participant{
+             this->participants_.load(std::memory_order_acquire)};
+         participant; participant = participant->next) {
+      uint64_t pinned{participant->epoch.load(std::memory_order_seq_cst)};
+      if (pinned != kInactive && pinned != epoch) {
+        return;
+      }
+    }
+    this->epoch_.compare_exchange_strong(epoch, epoch + 1,
+                                         std::memory_order_seq_cst);
+  }
+  // Makes up to advances attempts to advance the epoch, then collects.
+  void Reclaim(Participant& participant, int advances) {
+    for (int i{0}; i < advances; ++i) {
+      this->TryAdvance();
+    }
+    uint64_t epoch{this->epoch_.load(std::memory_order_acquire)};
+    Collect(participant.limbo, epoch);
+    if (std::unique_lock<std::mutex> lock{this->orphans_mutex_,
+                                          std::try_to_lock}) {
+      Collect(this->orphans_, epoch);
+    }
+    participant.collect_at = participant.limbo.size() + kCollectInterval;
+  }
+  // Deletes the objects retired at least two epochs ago.
+  static void Collect(std::vector<Retired>& retired, uint64_t epoch) {
+    size_t kept{0};
+    for (Retired& object : retired) {
+      if (object.epoch + 2 <= epoch) {
+        object.deleter(object.object);
+      } else {
+        retired[kept++] = object;
+      }
+    }
+    retired.resize(kept);
+  }
+
+  std::atomic<uint64_t> epoch_{0};
+  std::atomic<Participant*> participants_{nullptr};
+  std::mutex orphans_mutex_;
+  // Left behind by exited threads.
+  std::vector<Retired> orphans_;
+};
+
+}  // namespace concurrency
+
+#endif  // EPOCH_RECLAMATION_H_
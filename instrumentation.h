@@ -0,0 +1,93 @@
+#ifndef INSTRUMENTATION_H_
+#define INSTRUMENTATION_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Counters of the work done on the hot paths, compiled in with
+// -DASSIGNMENTS_INSTRUMENTATION. Without it INSTRUMENT_COUNT expands to
+// nothing and does not evaluate its arguments, so the counted code is the
+// same as without the macro. The counters are totals over all threads.
+namespace instrumentation {
+
+enum class Counter {
+  // Counted by whoever replaces operator new, as the benchmarks do.
+  kAllocations,
+  kAllocatedBytes,
+  // Limbs passed through the linear BigInteger kernels and butterflies of
+  // the NTT.
+  kLimbOperations,
+  // Value comparisons of the tree searches.
+  kComparisons,
+  // Nodes the tree searches descend through, their depth summed.
+  kTreeLevels,
+};
+inline constexpr size_t kCounterCount{5};
+inline constexpr const char* kCounterNames[kCounterCount]{
+    "allocations", "allocated_bytes", "limb_operations", "comparisons",
+    "tree_levels"};
+
+#ifdef ASSIGNMENTS_INSTRUMENTATION
+inline constexpr bool kIsEnabled{true};
+#else
+inline constexpr bool kIsEnabled{false};
+#endif
+
+inline std::atomic<uint64_t> totals[kCounterCount]{};
+
+inline void Add(Counter counter, uint64_t amount) {
+  totals[static_cast<size_t>(counter)].fetch_add(amount,
+                                                 std::memory_order_relaxed);
+}
+
+// Totals at one point, subtracted from each other to count a call.
+struct Snapshot {
+  static Snapshot Take() {
+    Snapshot snapshot;
+    for (size_t i{0}; i < kCounterCount; ++i) {
+      snapshot.values[i] = totals[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+  }
+
+  Snapshot& operator+=(const Snapshot& rhs) {
+    for (size_t i{0}; i < kCounterCount; ++i) {
+      this->values[i] += rhs.values[i];
+    }
+    return *this;
+  }
+  Snapshot operator-(const Snapshot& rhs) const {
+    Snapshot result{*this};
+    for (size_t i{0}; i < kCounterCount; ++i) {
+      result.values[i] -= rhs.values[i];
+    }
+    return result;
+  }
+
+  // An object with a member per counter, each divided by calls.
+  [[nodiscard]] std::string ToJson(double calls = 1) const {
+    std::string json{"{"};
+    for (size_t i{0}; i < kCounterCount; ++i) {
+      json += i == 0 ? "\"" : ", \"";
+      json += kCounterNames[i];
+      json += "\": ";
+      json += std::to_string(this->values[i] / calls);
+    }
+    return json + "}";
+  }
+
+  uint64_t values[kCounterCount]{};
+};
+
+}  // namespace instrumentation
+
+#ifdef ASSIGNMENTS_INSTRUMENTATION
+#define INSTRUMENT_COUNT(counter, amount)                              \
+  ::instrumentation::Add(::instrumentation::Counter::counter, (amount))
+#else
+#define INSTRUMENT_COUNT(counter, amount) static_cast<void>(0)
+#endif
+
+#endif  // INSTRUMENTATION_H_
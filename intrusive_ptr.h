@@ -0,0 +1,102 @@
+#ifndef INTRUSIVE_PTR_H_
+#define INTRUSIVE_PTR_H_
+
+#include <utility>
+
+#include "shared_ptr.h"
+
+namespace pointers {
+
+// Embeds the use count in Derived, which is deleted when the last
+// IntrusivePtr to it goes away. Neither the count nor the deletion is
+// virtual. The count starts at zero, so a raw pointer to a counted object,
+// such as this, can always be turned into another IntrusivePtr.
+template<typename Derived, typename Policy = NonAtomicPolicy>
+class RefCounted {
+ public:
+  void AddReference() const {
+    Policy::Increment(this->use_count_);
+  }
+  void Release() const {
+    if (Policy::Decrement(this->use_count_) == 0) {
+      delete static_cast<const Derived*>(this);
+    }
+  }
+  [[nodiscard]] int UseCount() const {
+    return Policy::Load(this->use_count_);
+  }
+
+ protected:
+  RefCounted() = default;
+  // A copy is a new object that nothing points to yet.
+  RefCounted(const RefCounted&) {}
+  RefCounted& operator=(const RefCounted&) {
+    return *this;
+  }
+  ~RefCounted() = default;
+
+ private:
+  mutable typename Policy::Count use_count_{0};
+};
+
+// Points to an object of a type with AddReference and Release, such as one
+// derived from RefCounted. Unlike SharedPtr it is a single pointer with no
+// counter of its own.
+template<typename T>
+class IntrusivePtr {
+ public:
+  IntrusivePtr() = default;
+  explicit IntrusivePtr(T* ptr) : ptr_(ptr) {
+    if (this->ptr_ != nullptr) {
+      this->ptr_->AddReference();
+    }
+  }
+  IntrusivePtr(const IntrusivePtr& source) : IntrusivePtr(source.ptr_) {}
+  IntrusivePtr(IntrusivePtr&& source) noexcept
+      : ptr_(std::exchange(source.ptr_, nullptr)) {}
+  ~IntrusivePtr() {
+    this->Reset();
+  }
+
+  IntrusivePtr& operator=(const IntrusivePtr& rhs) {
+    IntrusivePtr(rhs).Swap(*this);
+    return *this;
+  }
+  IntrusivePtr& operator=(IntrusivePtr&& rhs) noexcept {
+    IntrusivePtr(std::move(rhs)).Swap(*this);
+    return *this;
+  }
+
+  [[nodiscard]] T* Get() const {
+    return this->ptr_;
+  }
+  T& operator*() const {
+    return *this->ptr_;
+  }
+  T* operator->() const {
+    return this->ptr_;
+  }
+
+  bool operator==(const IntrusivePtr& rhs) const {
+    return this->ptr_ == rhs.ptr_;
+  }
+  bool operator==(const T* rhs) const {
+    return this->ptr_ == rhs;
+  }
+
+  void Reset() {
+    if (this->ptr_ != nullptr) {
+      std::exchange(this->ptr_, nullptr)->Release();
+    }
+  }
+  void Swap(IntrusivePtr& other) noexcept {
+    std::swap(this->ptr_, other.ptr_);
+  }
+
+ private:
+  T* ptr_{nullptr};
+};
+
+}  // namespace pointers
+
+#endif  // INTRUSIVE_PTR_H_
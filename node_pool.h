@@ -0,0 +1,220 @@
+#ifndef NODE_POOL_H_
+#define NODE_POOL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace containers {
+
+// Allocates nodes of one type from slabs obtained through Allocator. Freed
+// nodes are kept in a free list for reuse, and all slabs are handed back
+// at once by Release or on destruction, without visiting the nodes, so
+// tearing down a container costs one deallocation per slab.
+//
+// Pools may share slabs, so that containers can hand nodes to each other
+// without copying them. A slab is then returned with the last pool that
+// keeps it, and each pool still has its own free list, so pools sharing
+// slabs can be used from different threads.
+template<typename Node, typename Allocator = std::allocator<Node>>
+class NodePool {
+ private:
+  union Slot;
+  struct SlabHeader {
+    Slot* next;
+    size_t size;
+  };
+  union Slot {
+    SlabHeader header;
+    Slot* next_free;
+    alignas(Node) std::byte node[sizeof(Node)];
+  };
+  using SlotAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+  using SlotTraits = std::allocator_traits<SlotAllocator>;
+  // The slabs allocated by one pool.
+  struct SlabList {
+    explicit SlabList(const SlotAllocator& allocator) : allocator(allocator) {}
+    SlabList(const SlabList&) = delete;
+    SlabList& operator=(const SlabList&) = delete;
+    ~SlabList() {
+      while (this->first) {
+        Slot* next{this->first->header.next};
+        SlotTraits::deallocate(this->allocator, this->first,
+                               this->first->header.size);
+        this->first = next;
+      }
+    }
+
+    [[no_unique_address]] SlotAllocator allocator;
+    Slot* first{nullptr};
+  };
+
+ public:
+  using allocator_type = Allocator;
+
+  static constexpr size_t kMinSlabNodes = 16;
+  static constexpr size_t kMaxSlabNodes = 4096;
+
+  NodePool() = default;
+  explicit NodePool(const Allocator& allocator) : allocator_(allocator) {}
+  NodePool(const NodePool&) = delete;
+  NodePool(NodePool&& source) noexcept : allocator_(source.allocator_) {
+    this->StealFrom(source);
+  }
+  ~NodePool() { this->Release(); }
+  NodePool& operator=(const NodePool&) = delete;
+  // Requires both pools to have equal allocators.
+  NodePool& operator=(NodePool&& rhs) noexcept {
+    if (this != &rhs) {
+      this->Release();
+      this->StealFrom(rhs);
+    }
+    return *this;
+  }
+
+  [[nodiscard]] allocator_type get_allocator() const {
+    return allocator_type(this->allocator_);
+  }
+
+  template<typename... Ts>
+  [[nodiscard]] Node* New(Ts&&... args) {
+    Slot* slot{this->AllocateSlot()};
+    try {
+      return std::construct_at(reinterpret_cast<Node*>(slot->node),
+                               std::forward<Ts>(args)...);
+    } catch (...) {
+      this->FreeSlot(slot);
+      throw;
+    }
+  }
+  void Delete(Node* node) {
+    std::destroy_at(node);
+    this->FreeSlot(reinterpret_cast<Slot*>(node));
+  }
+
+  // Makes the next count nodes that are not taken from the free list
+  // adjacent in memory, in the order they are allocated.
+  void Reserve(size_t count) {
+    if (this->bump_end_ - this->bump_ < static_cast<ptrdiff_t>(count)) {
+      this->AddSlab(count);
+    }
+  }
+  // Returns the memory of all nodes without destroying them, except for
+  // the slabs other pools still keep.
+  void Release() {
+    this->slabs_.reset();
+    this->shared_slabs_.clear();
+    this->ResetFields();
+  }
+
+  // An empty pool that keeps the slabs of this one, so that nodes of this
+  // pool may be deleted into it.
+  [[nodiscard]] NodePool Share() const {
+    NodePool pool(this->get_allocator());
+    pool.shared_slabs_ = this->shared_slabs_;
+    if (this->slabs_) {
+      pool.shared_slabs_.push_back(this->slabs_);
+    }
+    return pool;
+  }
+  // Takes over the slabs and free nodes of the source, which is left empty,
+  // so that its nodes may be deleted into this pool. Requires both pools to
+  // have equal allocators.
+  void Adopt(NodePool&& source) {
+    if (this == &source) {
+      return;
+    }
+    this->Keep(std::move(source.slabs_));
+    for (std::shared_ptr<SlabList>& slabs : source.shared_slabs_) {
+      this->Keep(std::move(slabs));
+    }
+    if (source.free_) {
+      if (!this->free_) {
+        this->free_last_ = source.free_last_;
+      }
+      source.free_last_->next_free = this->free_;
+      this->free_ = source.free_;
+    }
+    if (source.bump_end_ - source.bump_ > this->bump_end_ - this->bump_) {
+      this->bump_ = source.bump_;
+      this->bump_end_ = source.bump_end_;
+    }
+    source.Release();
+  }
+
+ private:
+  Slot* AllocateSlot() {
+    if (this->free_) {
+      return std::exchange(this->free_, this->free_->next_free);
+    }
+    if (this->bump_ == this->bump_end_) {
+      this->AddSlab(std::clamp(2 * this->last_slab_nodes_, kMinSlabNodes,
+                               kMaxSlabNodes));
+    }
+    return this->bump_++;
+  }
+  void FreeSlot(Slot* slot) {
+    if (!this->free_) {
+      this->free_last_ = slot;
+    }
+    slot->next_free = this->free_;
+    this->free_ = slot;
+  }
+  // The first slot of a slab holds its header.
+  void AddSlab(size_t nodes) {
+    if (!this->slabs_) {
+      this->slabs_ =
+          std::allocate_shared<SlabList>(this->allocator_, this->allocator_);
+    }
+    Slot* slab{SlotTraits::allocate(this->allocator_, nodes + 1)};
+    slab->header = {this->slabs_->first, nodes + 1};
+    this->slabs_->first = slab;
+    this->bump_ = slab + 1;
+    this->bump_end_ = slab + 1 + nodes;
+    this->last_slab_nodes_ = nodes;
+  }
+  void Keep(std::shared_ptr<SlabList>&& slabs) {
+    if (slabs && slabs != this->slabs_ &&
+        std::find(this->shared_slabs_.begin(), this->shared_slabs_.end(),
+                  slabs) == this->shared_slabs_.end()) {
+      this->shared_slabs_.push_back(std::move(slabs));
+    }
+  }
+  void ResetFields() {
+    this->free_ = nullptr;
+    this->free_last_ = nullptr;
+    this->bump_ = nullptr;
+    this->bump_end_ = nullptr;
+    this->last_slab_nodes_ = 0;
+  }
+  void StealFrom(NodePool& source) {
+    this->slabs_ = std::move(source.slabs_);
+    this->shared_slabs_ = std::move(source.shared_slabs_);
+    source.shared_slabs_.clear();
+    this->free_ = source.free_;
+    this->free_last_ = source.free_last_;
+    this->bump_ = source.bump_;
+    this->bump_end_ = source.bump_end_;
+    this->last_slab_nodes_ = source.last_slab_nodes_;
+    source.ResetFields();
+  }
+
+  [[no_unique_address]] SlotAllocator allocator_;
+  // Made on the first allocation. Other pools may keep it too, but only
+  // this one adds slabs to it.
+  std::shared_ptr<SlabList> slabs_;
+  // Kept for nodes that came from other pools.
+  std::vector<std::shared_ptr<SlabList>> shared_slabs_;
+  Slot* free_{nullptr};
+  Slot* free_last_{nullptr};
+  Slot* bump_{nullptr};
+  Slot* bump_end_{nullptr};
+  size_t last_slab_nodes_{0};
+};
+
+}  // namespace containers
+
+#endif  // NODE_POOL_H_
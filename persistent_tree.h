@@ -0,0 +1,419 @@
+#ifndef PERSISTENT_TREE_H_
+#define PERSISTENT_TREE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+// Sorted multiset with the interface of BinarySearchTree whose copies
+// share their nodes. Nodes never change once built: insert and erase copy
+// the O(log n) nodes on the path to the change and keep the rest, so a copy
+// is an O(1) snapshot that later changes of either tree do not affect.
+// Nodes are reference counted atomically, so snapshots may be read and
+// dropped on different threads.
+//
+// Changing a tree invalidates its own iterators but not those of other
+// snapshots.
+template<typename T>
+class PersistentTree {
+ private:
+  struct Node {
+    template<typename U>
+    Node(U&& value, const Node* left, const Node* right)
+        : value(std::forward<U>(value)), left(left), right(right),
+          height(1 + std::max(Height(left), Height(right))),
+          size(1 + Size(left) + Size(right)) {}
+
+    const T value;
+    const Node* const left;
+    const Node* const right;
+    const int height;
+    const int size;
+    mutable std::atomic<int> references{1};
+  };
+
+ public:
+  class ConstIterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    reference operator*() const { return path_[depth_ - 1]->value; }
+    pointer operator->() const { return &path_[depth_ - 1]->value; }
+    ConstIterator& operator++();
+    ConstIterator operator++(int);
+    ConstIterator& operator--();
+    ConstIterator operator--(int);
+
+    bool operator==(const ConstIterator& rhs) const {
+      return depth_ == rhs.depth_ &&
+             (depth_ == 0 || path_[depth_ - 1] == rhs.path_[depth_ - 1]);
+    }
+    bool operator!=(const ConstIterator& rhs) const {
+      return !(*this == rhs);
+    }
+
+   private:
+    explicit ConstIterator(const Node* root) : root_(root) {}
+
+    friend class PersistentTree;
+
+    void PushLeftmost(const Node* node);
+    void PushRightmost(const Node* node);
+
+    const Node* root_;
+    // The nodes from the root down to the current one, none at the end.
+    // Heights of AVL trees with fewer than 2^31 nodes stay below 45.
+    const Node* path_[48];
+    int depth_{0};
+  };
+
+  PersistentTree() = default;
+  PersistentTree(std::initializer_list<T>);
+  PersistentTree(const PersistentTree& source) : root_(Retain(source.root_)) {}
+  PersistentTree(PersistentTree&& source) noexcept
+      : root_(std::exchange(source.root_, nullptr)) {}
+  ~PersistentTree() { Release(root_); }
+  PersistentTree& operator=(const PersistentTree& rhs) {
+    Replace(Retain(rhs.root_));
+    return *this;
+  }
+  PersistentTree& operator=(PersistentTree&& rhs) noexcept {
+    if (this != &rhs) {
+      Replace(std::exchange(rhs.root_, nullptr));
+    }
+    return *this;
+  }
+
+  [[nodiscard]] int size() const { return Size(root_); }
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  [[nodiscard]] bool contains(const T& value) const {
+    return find(value) != end();
+  }
+  [[nodiscard]] int count(const T& value) const {
+    return CountBelow<true>(value) - CountBelow<false>(value);
+  }
+  [[nodiscard]] std::vector<T> to_vector() const;
+  void clear() { Replace(nullptr); }
+
+  [[nodiscard]] ConstIterator begin() const;
+  [[nodiscard]] ConstIterator end() const { return ConstIterator(root_); }
+  // The first of the equal values, if any.
+  [[nodiscard]] ConstIterator find(const T&) const;
+
+  template<typename U>
+  void insert(U&& value) {
+    Replace(Insert(root_, T(std::forward<U>(value))));
+  }
+  template<typename... Ts>
+  void emplace(Ts&&... args) {
+    Replace(Insert(root_, T(std::forward<Ts>(args)...)));
+  }
+  void erase(const T& value) { erase(find(value)); }
+  void erase(ConstIterator);
+
+  // Subtrees that both trees share are compared by address, so comparing
+  // snapshots of one tree costs time in the number of changes between them
+  // rather than in their size.
+  bool operator==(const PersistentTree&) const;
+  bool operator!=(const PersistentTree& rhs) const { return !(*this == rhs); }
+
+ private:
+  static int Height(const Node* node) { return node ? node->height : 0; }
+  static int Size(const Node* node) { return node ? node->size : 0; }
+  static const Node* Retain(const Node* node) {
+    if (node) {
+      node->references.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+  }
+  static void Release(const Node* node);
+  // Takes over the reference to the new root.
+  void Replace(const Node* root) {
+    Release(std::exchange(root_, root));
+  }
+
+  // The functions building nodes take over the references to the subtrees
+  // they are given and return a new reference.
+  static const Node* Balance(const T& value, const Node* left,
+                             const Node* right);
+  static const Node* Insert(const Node*, T&& value);
+  // Removes the value of rank k in the subtree.
+  static const Node* EraseNth(const Node*, int k);
+
+  template<bool kOrEqual>
+  [[nodiscard]] int CountBelow(const T&) const;
+
+  const Node* root_{nullptr};
+};
+template<typename T>
+void PersistentTree<T>::ConstIterator::PushLeftmost(const Node* node) {
+  for (; node; node = node->left) {
+    path_[depth_++] = node;
+  }
+}
+template<typename T>
+void PersistentTree<T>::ConstIterator::PushRightmost(const Node* node) {
+  for (; node; node = node->right) {
+    path_[depth_++] = node;
+  }
+}
+template<typename T>
+typename PersistentTree<T>::ConstIterator&
+PersistentTree<T>::ConstIterator::operator++() {
+  const Node* node{path_[depth_ - 1]};
+  if (node->right) {
+    PushLeftmost(node->right);
+    return *this;
+  }
+  const Node* child;
+  do {
+    child = path_[--depth_];
+  } while (depth_ > 0 && path_[depth_ - 1]->right == child);
+  return *this;
+}
+template<typename T>
+typename PersistentTree<T>::ConstIterator
+PersistentTree<T>::ConstIterator::operator++(int) {
+  auto copy{*this};
+  ++*this;
+  return copy;
+}
+template<typename T>
+typename PersistentTree<T>::ConstIterator&
+PersistentTree<T>::ConstIterator::operator--() {
+  if (depth_ == 0) {
+    PushRightmost(root_);
+    return *this;
+  }
+  const Node* node{path_[depth_ - 1]};
+  if (node->left) {
+    PushRightmost(node->left);
+    return *this;
+  }
+  const Node* child;
+  do {
+    child = path_[--depth_];
+  } while (depth_ > 0 && path_[depth_ - 1]->left == child);
+  return *this;
+}
+template<typename T>
+typename PersistentTree<T>::ConstIterator
+PersistentTree<T>::ConstIterator::operator--(int) {
+  auto copy{*this};
+  --*this;
+  return copy;
+}
+template<typename T>
+PersistentTree<T>::PersistentTree(std::initializer_list<T> list) {
+  for (const T& value : list) {
+    insert(value);
+  }
+}
+template<typename T>
+std::vector<T> PersistentTree<T>::to_vector() const {
+  std::vector<T> result;
+  result.reserve(size());
+  for (const T& value : *this) {
+    result.push_back(value);
+  }
+  return result;
+}
+template<typename T>
+typename PersistentTree<T>::ConstIterator PersistentTree<T>::begin() const {
+  ConstIterator result(root_);
+  result.PushLeftmost(root_);
+  return result;
+}
+template<typename T>
+typename PersistentTree<T>::ConstIterator PersistentTree<T>::find(
+    const T& value) const {
+  ConstIterator result(root_);
+  // The path is kept up to the last node that is not less than the value.
+  int lower_bound_depth{0};
+  for (const Node* node{root_}; node;) {
+    result.path_[result.depth_++] = node;
+    if (node->value < value) {
+      node = node->right;
+    } else {
+      lower_bound_depth = result.depth_;
+      node = node->left;
+    }
+  }
+  result.depth_ = lower_bound_depth;
+  if (result != end() && *result == value) {
+    return result;
+  }
+  return end();
+}
+template<typename T>
+void PersistentTree<T>::erase(ConstIterator iter) {
+  if (iter == end()) {
+    return;
+  }
+  int rank{Size(iter.path_[iter.depth_ - 1]->left)};
+  for (int i{0}; i + 1 < iter.depth_; ++i) {
+    if (iter.path_[i]->right == iter.path_[i + 1]) {
+      rank += Size(iter.path_[i]->left) + 1;
+    }
+  }
+  Replace(EraseNth(root_, rank));
+}
+template<typename T>
+bool PersistentTree<T>::operator==(const PersistentTree& rhs) const {
+  if (size() != rhs.size()) {
+    return false;
+  }
+  // Both sides are the remaining sequence as a stack of pieces, the top
+  // first. A piece is a whole subtree or, with is_single, just the value of
+  // its root. Whole subtrees on top are split until both tops are the same
+  // subtree, which is skipped, or single values, which are compared.
+  struct Piece {
+    const Node* node;
+    bool is_single;
+  };
+  std::vector<Piece> lhs_pieces;
+  std::vector<Piece> rhs_pieces;
+  if (root_) {
+    lhs_pieces.push_back({root_, false});
+    rhs_pieces.push_back({rhs.root_, false});
+  }
+  auto split{[](std::vector<Piece>& pieces) {
+    const Node* node{pieces.back().node};
+    pieces.pop_back();
+    if (node->right) {
+      pieces.push_back({node->right, false});
+    }
+    pieces.push_back({node, true});
+    if (node->left) {
+      pieces.push_back({node->left, false});
+    }
+  }};
+  while (!lhs_pieces.empty()) {
+    Piece lhs_top{lhs_pieces.back()};
+    Piece rhs_top{rhs_pieces.back()};
+    if (!lhs_top.is_single && !rhs_top.is_single &&
+        lhs_top.node == rhs_top.node) {
+      lhs_pieces.pop_back();
+      rhs_pieces.pop_back();
+    } else if (!lhs_top.is_single &&
+               (rhs_top.is_single ||
+                lhs_top.node->size >= rhs_top.node->size)) {
+      split(lhs_pieces);
+    } else if (!rhs_top.is_single) {
+      split(rhs_pieces);
+    } else {
+      if (!(lhs_top.node->value == rhs_top.node->value)) {
+        return false;
+      }
+      lhs_pieces.pop_back();
+      rhs_pieces.pop_back();
+    }
+  }
+  return true;
+}
+template<typename T>
+void PersistentTree<T>::Release(const Node* node) {
+  if (node &&
+      node->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    Release(node->left);
+    Release(node->right);
+    delete node;
+  }
+}
+template<typename T>
+const typename PersistentTree<T>::Node* PersistentTree<T>::Balance(
+    const T& value, const Node* left, const Node* right) {
+  if (Height(left) > Height(right) + 1) {
+    const Node* result;
+    if (Height(left->left) >= Height(left->right)) {
+      result = new Node(left->value, Retain(left->left),
+                        new Node(value, Retain(left->right), right));
+    } else {
+      const Node* middle{left->right};
+      result = new Node(middle->value,
+                        new Node(left->value, Retain(left->left),
+                                 Retain(middle->left)),
+                        new Node(value, Retain(middle->right), right));
+    }
+    Release(left);
+    return result;
+  }
+  if (Height(right) > Height(left) + 1) {
+    const Node* result;
+    if (Height(right->right) >= Height(right->left)) {
+      result = new Node(right->value,
+                        new Node(value, left, Retain(right->left)),
+                        Retain(right->right));
+    } else {
+      const Node* middle{right->left};
+      result = new Node(middle->value,
+                        new Node(value, left, Retain(middle->left)),
+                        new Node(right->value, Retain(middle->right),
+                                 Retain(right->right)));
+    }
+    Release(right);
+    return result;
+  }
+  return new Node(value, left, right);
+}
+template<typename T>
+const typename PersistentTree<T>::Node* PersistentTree<T>::Insert(
+    const Node* node, T&& value) {
+  if (!node) {
+    return new Node(std::move(value), nullptr, nullptr);
+  }
+  // Equal values go right, behind the ones inserted before.
+  if (value < node->value) {
+    return Balance(node->value, Insert(node->left, std::move(value)),
+                   Retain(node->right));
+  }
+  return Balance(node->value, Retain(node->left),
+                 Insert(node->right, std::move(value)));
+}
+template<typename T>
+const typename PersistentTree<T>::Node* PersistentTree<T>::EraseNth(
+    const Node* node, int k) {
+  int left_size{Size(node->left)};
+  if (k < left_size) {
+    return Balance(node->value, EraseNth(node->left, k),
+                   Retain(node->right));
+  }
+  if (k > left_size) {
+    return Balance(node->value, Retain(node->left),
+                   EraseNth(node->right, k - left_size - 1));
+  }
+  if (!node->left || !node->right) {
+    return Retain(node->left ? node->left : node->right);
+  }
+  // The successor takes the place of the node.
+  const Node* successor{node->right};
+  while (successor->left) {
+    successor = successor->left;
+  }
+  return Balance(successor->value, Retain(node->left),
+                 EraseNth(node->right, 0));
+}
+template<typename T>
+template<bool kOrEqual>
+int PersistentTree<T>::CountBelow(const T& value) const {
+  int result{0};
+  for (const Node* node{root_}; node;) {
+    if (kOrEqual ? !(value < node->value) : node->value < value) {
+      result += Size(node->left) + 1;
+      node = node->right;
+    } else {
+      node = node->left;
+    }
+  }
+  return result;
+}
+
+#endif  // PERSISTENT_TREE_H_
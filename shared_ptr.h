@@ -1,11 +1,71 @@
 #ifndef SHARED_PTR_H_
 #define SHARED_PTR_H_
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
 #include <utility>
 
 namespace pointers {
 
-template<typename T>
+// Reference counting for objects that stay on one thread.
+struct NonAtomicPolicy {
+  using Count = int;
+
+  static void Increment(Count& count) {
+    ++count;
+  }
+  // Returns the count after the decrement.
+  static int Decrement(Count& count) {
+    return --count;
+  }
+  static int Load(const Count& count) {
+    return count;
+  }
+  // Increments the count unless it is zero.
+  static bool IncrementIfNonZero(Count& count) {
+    if (count == 0) {
+      return false;
+    }
+    ++count;
+    return true;
+  }
+};
+
+// Reference counting for objects that pointers on different threads share,
+// where each pointer is used by one thread at a time.
+struct AtomicPolicy {
+  using Count = std::atomic<int>;
+
+  // A new reference is made from one the thread already holds, so the
+  // increment orders nothing.
+  static void Increment(Count& count) {
+    count.fetch_add(1, std::memory_order_relaxed);
+  }
+  // The release orders the uses of the object through this reference
+  // before its destruction, and the acquire makes the last decrement see
+  // all of them.
+  static int Decrement(Count& count) {
+    return count.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  }
+  static int Load(const Count& count) {
+    return count.load(std::memory_order_acquire);
+  }
+  static bool IncrementIfNonZero(Count& count) {
+    int value{count.load(std::memory_order_relaxed)};
+    while (value != 0) {
+      if (count.compare_exchange_weak(value, value + 1,
+                                      std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+template<typename T, typename Policy = NonAtomicPolicy>
 class GeneralPtr {
  public:
   [[nodiscard]] T* Get() {
@@ -20,10 +80,59 @@ class GeneralPtr {
  protected:
   T* ptr_{nullptr};
 
+  // Null pointers have no counter. The SharedPtrs together hold one weak
+  // use, so that whichever count drops to zero last frees the counter.
   struct Counter {
-    explicit Counter(int use_count) : use_count(use_count) {}
-    int use_count{0};
-    int weak_use_count{0};
+    Counter() = default;
+    Counter(const Counter&) = delete;
+    Counter& operator=(const Counter&) = delete;
+    virtual ~Counter() = default;
+    // Called when the last SharedPtr goes away.
+    virtual void DestroyObject() = 0;
+    // Called when the last SharedPtr and the last WeakPtr are gone.
+    virtual void Deallocate() = 0;
+
+    typename Policy::Count use_count{1};
+    typename Policy::Count weak_use_count{1};
+  };
+  // For an object allocated by the caller.
+  struct PointerCounter : Counter {
+    explicit PointerCounter(T* ptr) : ptr(ptr) {}
+    void DestroyObject() override {
+      delete this->ptr;
+    }
+    void Deallocate() override {
+      delete this;
+    }
+
+    T* ptr;
+  };
+  // Holds the object in the same allocation, made through Allocator.
+  template<typename Allocator>
+  struct InlineCounter : Counter {
+    using ObjectAllocator = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<T>;
+    using SelfAllocator = typename std::allocator_traits<
+        Allocator>::template rebind_alloc<InlineCounter>;
+
+    explicit InlineCounter(const Allocator& allocator)
+        : allocator(allocator) {}
+    T* Object() {
+      return std::launder(reinterpret_cast<T*>(this->storage));
+    }
+    void DestroyObject() override {
+      std::allocator_traits<ObjectAllocator>::destroy(this->allocator,
+                                                      this->Object());
+    }
+    void Deallocate() override {
+      SelfAllocator self_allocator(this->allocator);
+      std::destroy_at(this);
+      std::allocator_traits<SelfAllocator>::deallocate(self_allocator, this,
+                                                       1);
+    }
+
+    [[no_unique_address]] ObjectAllocator allocator;
+    alignas(T) std::byte storage[sizeof(T)];
   };
   Counter* counter_{nullptr};
 
@@ -40,21 +149,40 @@ class GeneralPtr {
   GeneralPtr() = default;
 };
 
-template<typename T>
-class SharedPtr : public GeneralPtr<T> {
+template<typename T, typename Policy = NonAtomicPolicy>
+class SharedPtr;
+
+// Both put the counter and the object into one allocation.
+template<typename T, typename Policy = NonAtomicPolicy, typename Allocator,
+         typename... Ts>
+SharedPtr<T, Policy> AllocateShared(const Allocator& allocator, Ts&&... args);
+template<typename T, typename Policy = NonAtomicPolicy, typename... Ts>
+SharedPtr<T, Policy> MakeShared(Ts&&... args) {
+  return AllocateShared<T, Policy>(std::allocator<T>(),
+                                   std::forward<Ts>(args)...);
+}
+
+// With AtomicPolicy, pointers to one object may be copied, reset and
+// locked from different threads.
+template<typename T, typename Policy>
+class SharedPtr : public GeneralPtr<T, Policy> {
+  using Counter = typename GeneralPtr<T, Policy>::Counter;
+
  public:
-  SharedPtr() {
-    this->InitNullptr();
-  }
+  SharedPtr() = default;
   explicit SharedPtr(T* ptr) {
-    this->ptr_ = ptr;
-    this->counter_ = new typename GeneralPtr<T>::Counter(1);
+    if (ptr != nullptr) {
+      this->counter_ =
+          new typename GeneralPtr<T, Policy>::PointerCounter(ptr);
+      this->ptr_ = ptr;
+    }
   }
   SharedPtr(const SharedPtr& source) {
     *this = source;
   }
   SharedPtr(SharedPtr&& source) noexcept {
-    *this = source;
+    this->CopyPointersFrom(source);
+    source.Unbind();
   }
   ~SharedPtr() override {
     this->ReleaseMemory();
@@ -66,7 +194,9 @@ class SharedPtr : public GeneralPtr<T> {
     }
     this->ReleaseMemory();
     this->CopyPointersFrom(rhs);
-    ++this->counter_->use_count;
+    if (this->counter_ != nullptr) {
+      Policy::Increment(this->counter_->use_count);
+    }
     return *this;
   }
   SharedPtr& operator=(SharedPtr&& rhs) noexcept {
@@ -114,42 +244,54 @@ class SharedPtr : public GeneralPtr<T> {
 
   void Reset() {
     this->ReleaseMemory();
-    this->InitNullptr();
   }
 
  private:
-  template<typename>
+  template<typename, typename>
   friend class WeakPtr;
-
-  void InitNullptr() {
-    this->ptr_ = nullptr;
-    this->counter_ = new typename GeneralPtr<T>::Counter(1);
-  }
+  template<typename U, typename UPolicy, typename Allocator, typename... Ts>
+  friend SharedPtr<U, UPolicy> AllocateShared(const Allocator&, Ts&&...);
 
   void ReleaseMemory() {
     if (this->counter_ == nullptr) {
-      // `this` is already invalid
       return;
     }
-    --this->counter_->use_count;
-    if (this->counter_->use_count == 0) {
-      delete this->ptr_;
-      if (this->counter_->weak_use_count == 0) {
-        delete this->counter_;
+    if (Policy::Decrement(this->counter_->use_count) == 0) {
+      this->counter_->DestroyObject();
+      if (Policy::Decrement(this->counter_->weak_use_count) == 0) {
+        this->counter_->Deallocate();
       }
     }
     this->Unbind();
   }
 
-  SharedPtr(T* ptr, typename GeneralPtr<T>::Counter* imposed_counter) {
+  // Takes over a use the caller has already counted.
+  SharedPtr(T* ptr, Counter* counted) {
     this->ptr_ = ptr;
-    this->counter_ = imposed_counter;
-    if (this->counter_ != nullptr) {
-      ++this->counter_->use_count;
-    }
+    this->counter_ = counted;
   }
 };
 
+template<typename T, typename Policy, typename Allocator, typename... Ts>
+SharedPtr<T, Policy> AllocateShared(const Allocator& allocator,
+                                    Ts&&... args) {
+  using Counter =
+      typename SharedPtr<T, Policy>::template InlineCounter<Allocator>;
+  using Traits = std::allocator_traits<typename Counter::SelfAllocator>;
+  typename Counter::SelfAllocator self_allocator(allocator);
+  Counter* counter{Traits::allocate(self_allocator, 1)};
+  std::construct_at(counter, allocator);
+  try {
+    std::allocator_traits<typename Counter::ObjectAllocator>::construct(
+        counter->allocator, counter->Object(), std::forward<Ts>(args)...);
+  } catch (...) {
+    std::destroy_at(counter);
+    Traits::deallocate(self_allocator, counter, 1);
+    throw;
+  }
+  return SharedPtr<T, Policy>(counter->Object(), counter);
+}
+
 }  // namespace pointers
 
 #endif  // SHARED_PTR_H_
@@ -0,0 +1,126 @@
+// Readers load two AtomicSharedPtr slots while writers replace them: the
+// first with Store and Exchange, the second with CompareExchange
+// increments, whose count must come out exact. Every published object
+// checks its contents on each read, and the objects still alive are
+// counted after each writer's replacements and once all threads have
+// joined, when only the two stored ones may be left. Meant to be run
+// under ThreadSanitizer and AddressSanitizer as well. Exits with a nonzero
+// status at the first failure.
+//
+//   g++ -std=c++20 -O1 -g -fsanitize=address -pthread -I.
+//       -o atomic_shared_ptr_stress tests/atomic_shared_ptr_stress.cpp
+//   ./atomic_shared_ptr_stress [readers] [writers] [replacements per writer]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "atomic_shared_ptr.h"
+
+namespace {
+
+using pointers::AtomicSharedPtr;
+
+std::atomic<int64_t> live_objects{0};
+
+// A published table whose two fields must always agree.
+struct Table {
+  explicit Table(uint64_t version) : version(version), check(~version) {
+    live_objects.fetch_add(1, std::memory_order_relaxed);
+  }
+  Table(const Table&) = delete;
+  Table& operator=(const Table&) = delete;
+  ~Table() {
+    check = version;
+    live_objects.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] bool IsIntact() const { return check == ~version; }
+
+  uint64_t version;
+  uint64_t check;
+};
+
+using Pointer = AtomicSharedPtr<Table>::Pointer;
+
+Pointer NewTable(uint64_t version) {
+  return pointers::MakeShared<Table, pointers::AtomicPolicy>(version);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int reader_count{argc > 1 ? std::atoi(argv[1]) : 4};
+  int writer_count{argc > 2 ? std::atoi(argv[2]) : 4};
+  int replacements{argc > 3 ? std::atoi(argv[3]) : 20000};
+  AtomicSharedPtr<Table> stored{NewTable(0)};
+  AtomicSharedPtr<Table> counted{NewTable(0)};
+  std::atomic<bool> has_failed{false};
+  std::atomic<int> writers_running{writer_count};
+  // The most objects alive right after a writer's replacement.
+  std::atomic<int64_t> peak{0};
+  std::vector<std::thread> threads;
+  for (int reader{0}; reader < reader_count; ++reader) {
+    threads.emplace_back([&] {
+      uint64_t last_count{0};
+      while (writers_running.load(std::memory_order_relaxed) > 0) {
+        Pointer table{stored.Load()};
+        Pointer count{counted.Load()};
+        if (!table.Get() || !count.Get() || !table->IsIntact() ||
+            !count->IsIntact() || count->version < last_count) {
+          has_failed = true;
+          return;
+        }
+        last_count = count->version;
+      }
+    });
+  }
+  for (int writer{0}; writer < writer_count; ++writer) {
+    threads.emplace_back([&, writer] {
+      for (int i{0}; i < replacements; ++i) {
+        uint64_t version{static_cast<uint64_t>(writer) * replacements + i};
+        Pointer table{NewTable(version)};
+        if (i % 2 == 0) {
+          stored.Store(std::move(table));
+        } else {
+          Pointer previous{stored.Exchange(std::move(table))};
+          if (!previous.Get() || !previous->IsIntact()) {
+            has_failed = true;
+          }
+        }
+        Pointer expected{counted.Load()};
+        while (!counted.CompareExchange(expected,
+                                        NewTable(expected->version + 1))) {
+        }
+        int64_t alive{live_objects.load(std::memory_order_relaxed)};
+        int64_t highest{peak.load(std::memory_order_relaxed)};
+        while (alive > highest &&
+               !peak.compare_exchange_weak(highest, alive,
+                                           std::memory_order_relaxed)) {
+        }
+      }
+      writers_running.fetch_sub(1, std::memory_order_relaxed);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  if (counted.Load()->version !=
+      static_cast<uint64_t>(writer_count) * replacements) {
+    has_failed = true;
+  }
+  // Collects what the exited threads have left to the domain.
+  concurrency::EpochDomain::Default().TryCollect();
+  int64_t left{live_objects.load()};
+  if (left != 2) {
+    has_failed = true;
+  }
+  std::printf("peak %lld objects alive, %lld left\n",
+              static_cast<long long>(peak.load()),
+              static_cast<long long>(left));
+  std::printf(has_failed ? "FAILED\n" : "ok\n");
+  return has_failed ? 1 : 0;
+}
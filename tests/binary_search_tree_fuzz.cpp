@@ -0,0 +1,61 @@
+// Random inserts and erases on BinarySearchTree, checked against
+// std::multiset, with the invariants of the tree verified after every
+// step. Exits with a nonzero status at the first failure.
+//
+//   g++ -std=c++20 -O2 -pthread -I. -o binary_search_tree_fuzz
+//       tests/binary_search_tree_fuzz.cpp
+//   ./binary_search_tree_fuzz [steps] [seed]
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "binary_search_tree.h"
+
+namespace {
+
+template<TreeBalancing Balancing>
+bool Fuzz(int steps, uint64_t seed, int key_range) {
+  std::mt19937_64 random_engine{seed};
+  BinarySearchTree<int, Balancing> tree;
+  std::multiset<int> expected;
+  for (int step{0}; step < steps; ++step) {
+    int key{static_cast<int>(random_engine() % key_range)};
+    // Inserts outweigh erases while the tree is small, so it keeps growing
+    // to about key_range values.
+    if (random_engine() % key_range >= expected.size()) {
+      tree.insert(key);
+      expected.insert(key);
+    } else {
+      tree.erase(key);
+      if (auto iter{expected.find(key)}; iter != expected.end()) {
+        expected.erase(iter);
+      }
+    }
+    if (!tree.IsValid() ||
+        tree.to_vector() != std::vector<int>(expected.begin(),
+                                             expected.end())) {
+      std::printf("failed at step %d with seed %llu and key range %d\n", step,
+                  static_cast<unsigned long long>(seed), key_range);
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int steps{argc > 1 ? std::atoi(argv[1]) : 20000};
+  uint64_t seed{argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1};
+  bool is_ok{true};
+  for (int key_range : {8, 64, 1024}) {
+    is_ok &= Fuzz<TreeBalancing::kAvl>(steps, seed, key_range);
+    is_ok &= Fuzz<TreeBalancing::kNone>(steps, seed, key_range);
+  }
+  std::printf(is_ok ? "ok\n" : "FAILED\n");
+  return is_ok ? 0 : 1;
+}
@@ -0,0 +1,177 @@
+// Producers push numbered values into each queue of concurrent_queue.h,
+// singly and in bulk, while consumers pop them, singly and in bulk: the
+// MPMC ring with several threads on each side, the SPSC ring with one and
+// LinkedQueue with several. Every value must come out exactly once, and
+// the values of one producer in the order it pushed them to every
+// consumer. Meant to be run under ThreadSanitizer and AddressSanitizer as
+// well. Exits with a nonzero status at the first failure.
+//
+//   g++ -std=c++20 -O1 -g -fsanitize=thread -pthread -I.
+//       -o concurrent_queue_stress tests/concurrent_queue_stress.cpp
+//   ./concurrent_queue_stress [threads per side] [values per producer]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "concurrent_queue.h"
+
+namespace {
+
+using concurrency::BoundedQueue;
+using concurrency::LinkedQueue;
+using concurrency::QueueAccess;
+
+constexpr size_t kCapacity = 64;
+constexpr size_t kMaxBulk = 8;
+
+// The value number i of a producer is producer * values + i.
+struct Run {
+  int producers;
+  int consumers;
+  uint64_t values;
+};
+
+uint64_t Next(uint64_t& state) {
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+// Pushes all values of the producer, waiting while a bounded queue is full.
+template<typename Queue>
+void Produce(Queue& queue, const Run& run, int producer) {
+  uint64_t state{0x9E3779B97F4A7C15u * (producer + 1)};
+  uint64_t first{producer * run.values};
+  uint64_t end{first + run.values};
+  std::vector<uint64_t> batch;
+  for (uint64_t value{first}; value < end;) {
+    uint64_t random{Next(state)};
+    if (random & 1) {
+      if constexpr (requires { queue.Push(value); }) {
+        queue.Push(value++);
+      } else if (queue.TryPush(value)) {
+        ++value;
+      } else {
+        std::this_thread::yield();
+      }
+      continue;
+    }
+    batch.clear();
+    for (uint64_t i{0}; i < 1 + random % kMaxBulk && value + i < end; ++i) {
+      batch.push_back(value + i);
+    }
+    if constexpr (requires { queue.Push(value); }) {
+      queue.PushBulk(batch.begin(), batch.end());
+      value += batch.size();
+    } else {
+      size_t pushed{queue.PushBulk(batch.begin(), batch.end())};
+      value += pushed;
+      if (pushed == 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+}
+
+// Pops until all values of all producers are out, and checks that each
+// producer's values arrive in order. seen counts every value.
+template<typename Queue>
+bool Consume(Queue& queue, const Run& run, int consumer,
+             std::atomic<uint64_t>& popped,
+             std::vector<std::atomic<uint8_t>>& seen) {
+  uint64_t state{0xD1B54A32D192ED03u * (consumer + 1)};
+  uint64_t total{run.producers * run.values};
+  // The next value expected at least from each producer.
+  std::vector<uint64_t> next(run.producers);
+  for (int producer{0}; producer < run.producers; ++producer) {
+    next[producer] = producer * run.values;
+  }
+  bool is_ok{true};
+  auto check = [&](uint64_t value) {
+    if (value >= total) {
+      is_ok = false;
+      return;
+    }
+    uint64_t producer{value / run.values};
+    is_ok &= value >= next[producer];
+    next[producer] = value + 1;
+    is_ok &= seen[value].fetch_add(1, std::memory_order_relaxed) == 0;
+  };
+  uint64_t values[kMaxBulk];
+  while (popped.load(std::memory_order_relaxed) < total) {
+    uint64_t random{Next(state)};
+    size_t count{0};
+    if (random & 1) {
+      if (std::optional<uint64_t> value{queue.TryPop()}) {
+        values[0] = *value;
+        count = 1;
+      }
+    } else {
+      count = queue.PopBulk(values, 1 + random % kMaxBulk);
+    }
+    if (count == 0) {
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t i{0}; i < count; ++i) {
+      check(values[i]);
+    }
+    popped.fetch_add(count, std::memory_order_relaxed);
+  }
+  return is_ok;
+}
+
+template<typename Queue>
+bool Stress(const char* name, Queue& queue, const Run& run) {
+  std::atomic<uint64_t> popped{0};
+  std::vector<std::atomic<uint8_t>> seen(run.producers * run.values);
+  std::atomic<bool> has_failed{false};
+  std::vector<std::thread> threads;
+  for (int producer{0}; producer < run.producers; ++producer) {
+    threads.emplace_back([&, producer] { Produce(queue, run, producer); });
+  }
+  for (int consumer{0}; consumer < run.consumers; ++consumer) {
+    threads.emplace_back([&, consumer] {
+      if (!Consume(queue, run, consumer, popped, seen)) {
+        has_failed = true;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  for (std::atomic<uint8_t>& count : seen) {
+    has_failed = has_failed || count.load() != 1;
+  }
+  has_failed = has_failed || queue.TryPop().has_value();
+  std::printf("%-12s %s\n", name, has_failed ? "FAILED" : "ok");
+  return !has_failed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int thread_count{argc > 1 ? std::atoi(argv[1]) : 4};
+  uint64_t values{argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000};
+  Run run{thread_count, thread_count, values};
+  bool is_ok{true};
+  {
+    BoundedQueue<uint64_t> queue(kCapacity);
+    is_ok &= Stress("mpmc_ring", queue, run);
+  }
+  {
+    BoundedQueue<uint64_t, QueueAccess::kSpsc> queue(kCapacity);
+    is_ok &= Stress("spsc_ring", queue, Run{1, 1, values * thread_count});
+  }
+  {
+    LinkedQueue<uint64_t> queue;
+    is_ok &= Stress("linked", queue, run);
+  }
+  return is_ok ? 0 : 1;
+}
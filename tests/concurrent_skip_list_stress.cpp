@@ -0,0 +1,92 @@
+// Threads insert, erase and look up random values in one
+// ConcurrentSkipList. Every thread owns the values whose key is its index
+// modulo the thread count and tracks how many copies of each it holds, so
+// the final contents and every lookup of a thread's own values can be
+// checked exactly, while the other threads keep changing the list. Meant to
+// be run under ThreadSanitizer and AddressSanitizer as well. Exits with
+// a nonzero status at the first failure.
+//
+//   g++ -std=c++20 -O1 -g -fsanitize=thread -pthread -I.
+//       -o concurrent_skip_list_stress tests/concurrent_skip_list_stress.cpp
+//   ./concurrent_skip_list_stress [threads] [operations per thread]
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "concurrent_skip_list.h"
+
+namespace {
+
+constexpr int kKeysPerThread = 64;
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int thread_count{argc > 1 ? std::atoi(argv[1]) : 8};
+  int operations{argc > 2 ? std::atoi(argv[2]) : 200000};
+  concurrency::ConcurrentSkipList<int> list;
+  std::atomic<bool> has_failed{false};
+  // copies[thread][i] counts the copies of thread + i * thread_count.
+  std::vector<std::vector<int>> copies(thread_count,
+                                       std::vector<int>(kKeysPerThread));
+  std::vector<std::thread> threads;
+  for (int thread{0}; thread < thread_count; ++thread) {
+    threads.emplace_back([&, thread] {
+      std::vector<int>& own{copies[thread]};
+      uint64_t state{0x9E3779B97F4A7C15u * (thread + 1)};
+      for (int operation{0}; operation < operations; ++operation) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int index{static_cast<int>(state % kKeysPerThread)};
+        int value{thread + index * thread_count};
+        switch (state >> 32 & 3) {
+          case 0:
+          case 1:
+            list.insert(value);
+            ++own[index];
+            break;
+          case 2:
+            if (list.erase(value) != (own[index] > 0)) {
+              has_failed = true;
+            }
+            own[index] -= own[index] > 0;
+            break;
+          default: {
+            std::optional<int> found{list.find(value)};
+            if (list.contains(value) != (own[index] > 0) ||
+                found.has_value() != (own[index] > 0) ||
+                (found && *found != value)) {
+              has_failed = true;
+            }
+            // Values of the other threads may or may not be there.
+            (void)list.contains(value + 1);
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  std::vector<int> expected;
+  for (int thread{0}; thread < thread_count; ++thread) {
+    for (int i{0}; i < kKeysPerThread; ++i) {
+      expected.insert(expected.end(), copies[thread][i],
+                      thread + i * thread_count);
+    }
+  }
+  std::sort(expected.begin(), expected.end());
+  if (list.to_vector() != expected ||
+      list.size() != static_cast<int>(expected.size())) {
+    has_failed = true;
+  }
+  std::printf(has_failed ? "FAILED\n" : "ok\n");
+  return has_failed ? 1 : 0;
+}
@@ -0,0 +1,237 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace concurrency {
+
+// Fork-join pool with a task deque per worker. The owner of a deque takes
+// the newest tasks from it and idle threads steal the oldest ones from the
+// others. A thread that waits for its tasks runs queued tasks meanwhile, so
+// tasks may fork and wait themselves without exhausting the pool.
+class ThreadPool {
+ public:
+  // The thread count includes the calling thread, so a pool of one thread
+  // runs everything inline and zero stands for the hardware concurrency.
+  explicit ThreadPool(size_t thread_count) {
+    if (thread_count == 0) {
+      thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i{0}; i < thread_count; ++i) {
+      this->queues_.push_back(std::make_unique<Queue>());
+    }
+    this->workers_.reserve(thread_count - 1);
+    for (size_t i{0}; i + 1 < thread_count; ++i) {
+      this->workers_.emplace_back([this, i] { this->WorkerLoop(i); });
+    }
+  }
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+      this->is_stopping_ = true;
+    }
+    this->wake_up_.notify_all();
+    for (std::thread& worker : this->workers_) {
+      worker.join();
+    }
+  }
+
+  [[nodiscard]] size_t ThreadCount() const {
+    return this->workers_.size() + 1;
+  }
+  [[nodiscard]] bool IsParallel() const { return !this->workers_.empty(); }
+
+  // Runs the functions, possibly in parallel, and returns when all of them
+  // are done. The first exception thrown by them is rethrown.
+  template<typename First, typename... Rest>
+  void Invoke(First&& first, Rest&&... rest) {
+    if (!this->IsParallel()) {
+      first();
+      (rest(), ...);
+      return;
+    }
+    TaskGroup group(sizeof...(rest));
+    (this->Push(Task{[&rest] { rest(); }, &group}), ...);
+    group.Run([&first] { first(); });
+    this->Wait(group);
+  }
+  // Calls function(first, last) for consecutive subranges of [begin, end)
+  // that are at least grain long, possibly in parallel.
+  template<typename Function>
+  void ParallelFor(size_t begin, size_t end, size_t grain,
+                   Function&& function) {
+    size_t size{end - begin};
+    size_t parts{std::min(4 * this->ThreadCount(),
+                          size / std::max<size_t>(grain, 1))};
+    if (!this->IsParallel() || parts <= 1) {
+      if (begin < end) {
+        function(begin, end);
+      }
+      return;
+    }
+    auto bound{[&](size_t part) { return begin + size * part / parts; }};
+    TaskGroup group(parts - 1);
+    for (size_t part{1}; part < parts; ++part) {
+      this->Push(Task{[&function, first = bound(part),
+                       last = bound(part + 1)] { function(first, last); },
+                      &group});
+    }
+    group.Run([&] { function(begin, bound(1)); });
+    this->Wait(group);
+  }
+
+  // The pool the library code forks into. It stays single-threaded until
+  // SetDefaultThreadCount is called, which must not happen while the
+  // default pool is in use.
+  static ThreadPool& Default() { return *DefaultSlot(); }
+  static void SetDefaultThreadCount(size_t thread_count) {
+    DefaultSlot() = std::make_unique<ThreadPool>(thread_count);
+  }
+
+ private:
+  class TaskGroup {
+   public:
+    explicit TaskGroup(size_t pending) : pending_(pending) {}
+
+    template<typename Function>
+    void Run(Function&& function) {
+      try {
+        function();
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(this->error_mutex_);
+        if (!this->error_) {
+          this->error_ = std::current_exception();
+        }
+      }
+    }
+    void Finish() { this->pending_.fetch_sub(1, std::memory_order_release); }
+    [[nodiscard]] bool IsDone() const {
+      return this->pending_.load(std::memory_order_acquire) == 0;
+    }
+    void RethrowError() {
+      if (this->error_) {
+        std::rethrow_exception(this->error_);
+      }
+    }
+
+   private:
+    std::atomic<size_t> pending_;
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+  };
+  struct Task {
+    std::function<void()> function;
+    TaskGroup* group{nullptr};
+  };
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  static std::unique_ptr<ThreadPool>& DefaultSlot() {
+    static std::unique_ptr<ThreadPool> pool{std::make_unique<ThreadPool>(1)};
+    return pool;
+  }
+  // The worker running on this thread, if any.
+  static std::pair<const ThreadPool*, size_t>& CurrentWorker() {
+    thread_local std::pair<const ThreadPool*, size_t> worker{nullptr, 0};
+    return worker;
+  }
+  // Workers own the first queues, the last one is shared by the threads
+  // outside the pool.
+  [[nodiscard]] size_t OwnQueue() const {
+    auto [pool, index]{CurrentWorker()};
+    return pool == this ? index : this->queues_.size() - 1;
+  }
+
+  void Push(Task task) {
+    Queue& queue{*this->queues_[this->OwnQueue()]};
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(std::move(task));
+      this->queued_.fetch_add(1, std::memory_order_release);
+    }
+    {
+      std::lock_guard<std::mutex> lock(this->sleep_mutex_);
+    }
+    this->wake_up_.notify_one();
+  }
+  bool TryPop(Task& task) {
+    size_t own{this->OwnQueue()};
+    for (size_t i{0}; i < this->queues_.size(); ++i) {
+      Queue& queue{*this->queues_[(own + i) % this->queues_.size()]};
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      if (queue.tasks.empty()) {
+        continue;
+      }
+      if (i == 0) {
+        task = std::move(queue.tasks.back());
+        queue.tasks.pop_back();
+      } else {
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+      }
+      this->queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    return false;
+  }
+  bool RunOne() {
+    Task task;
+    if (!this->TryPop(task)) {
+      return false;
+    }
+    task.group->Run(task.function);
+    task.group->Finish();
+    return true;
+  }
+  void Wait(TaskGroup& group) {
+    while (!group.IsDone()) {
+      if (!this->RunOne()) {
+        std::this_thread::yield();
+      }
+    }
+    group.RethrowError();
+  }
+  void WorkerLoop(size_t index) {
+    CurrentWorker() = {this, index};
+    while (true) {
+      if (this->RunOne()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(this->sleep_mutex_);
+      this->wake_up_.wait(lock, [this] {
+        return this->is_stopping_ ||
+               this->queued_.load(std::memory_order_acquire) != 0;
+      });
+      if (this->is_stopping_ &&
+          this->queued_.load(std::memory_order_acquire) == 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_up_;
+  bool is_stopping_{false};
+};
+
+}  // namespace concurrency
+
+#endif  // THREAD_POOL_H_
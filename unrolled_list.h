@@ -0,0 +1,468 @@
+#ifndef UNROLLED_LIST_H_
+#define UNROLLED_LIST_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "node_pool.h"
+
+namespace containers {
+
+// BiDirectionalList that keeps its elements in chunks of about 512 bytes,
+// which come from a pool. Pushing and popping at either end takes O(1),
+// and so does inserting or erasing at a position, which moves elements
+// within a chunk only. Indexing skips whole chunks.
+//
+// A position stays valid until an element is inserted into or erased from
+// any chunk next to its own.
+template<typename T, typename Allocator = std::allocator<T>>
+class UnrolledList {
+ private:
+  static constexpr int kCapacity =
+      std::max<int>(4, static_cast<int>(512 / sizeof(T)));
+
+  struct Chunk {
+    T* Slots() { return std::launder(reinterpret_cast<T*>(this->storage)); }
+    T* Begin() { return this->Slots() + this->first; }
+    T* End() { return this->Begin() + this->size; }
+
+    Chunk* prev{nullptr};
+    Chunk* next{nullptr};
+    // The elements take slots [first, first + size).
+    int first{0};
+    int size{0};
+    alignas(T) std::byte storage[kCapacity * sizeof(T)];
+  };
+
+  template<bool kConst>
+  class BasicPosition {
+   public:
+    using reference = std::conditional_t<kConst, const T&, T&>;
+    using pointer = std::conditional_t<kConst, const T*, T*>;
+
+    // Positions may be made const.
+    template<bool kOtherConst>
+      requires(kConst || !kOtherConst)
+    BasicPosition(const BasicPosition<kOtherConst>& source)
+        : chunk_(source.chunk_), index_(source.index_) {}
+
+    reference operator*() const {
+      return this->chunk_->Begin()[this->index_];
+    }
+    pointer operator->() const { return &**this; }
+    bool operator==(const BasicPosition& rhs) const {
+      return this->chunk_ == rhs.chunk_ && this->index_ == rhs.index_;
+    }
+    bool operator!=(const BasicPosition& rhs) const { return !(*this == rhs); }
+
+   private:
+    BasicPosition(Chunk* chunk, int index) : chunk_(chunk), index_(index) {}
+
+    friend class UnrolledList;
+    friend class BasicPosition<!kConst>;
+
+    Chunk* chunk_;
+    int index_;
+  };
+
+ public:
+  using Position = BasicPosition<false>;
+  using ConstPosition = BasicPosition<true>;
+
+  UnrolledList() = default;
+  explicit UnrolledList(const Allocator& allocator) : pool_(allocator) {}
+  UnrolledList(std::initializer_list<T> source,
+               const Allocator& allocator = Allocator())
+      : pool_(allocator) {
+    for (const T& element : source) {
+      this->PushBack(element);
+    }
+  }
+  UnrolledList(const UnrolledList& source)
+      : pool_(std::allocator_traits<Allocator>::
+                  select_on_container_copy_construction(
+                      source.pool_.get_allocator())) {
+    this->CopyFrom(source);
+  }
+  UnrolledList(UnrolledList&& source) noexcept
+      : pool_(std::move(source.pool_)) {
+    this->CopyFieldsFrom(source);
+    source.ResetFields();
+  }
+  ~UnrolledList() {
+    this->ReleaseMemory();
+  }
+
+  UnrolledList& operator=(const UnrolledList& rhs) {
+    if (this == &rhs) {
+      return *this;
+    }
+    this->ReleaseMemory();
+    this->CopyFrom(rhs);
+    return *this;
+  }
+  // Copies the elements when the allocators differ.
+  UnrolledList& operator=(UnrolledList&& rhs) noexcept(
+      std::allocator_traits<Allocator>::is_always_equal::value) {
+    if (this == &rhs) {
+      return *this;
+    }
+    this->ReleaseMemory();
+    if (this->pool_.get_allocator() != rhs.pool_.get_allocator()) {
+      this->CopyFrom(rhs);
+      return *this;
+    }
+    this->pool_ = std::move(rhs.pool_);
+    this->CopyFieldsFrom(rhs);
+    rhs.ResetFields();
+    return *this;
+  }
+
+  [[nodiscard]] int Size() const {
+    return this->size_;
+  }
+  [[nodiscard]] bool IsEmpty() const {
+    return this->size_ == 0;
+  }
+
+  std::vector<T> ToVector() const {
+    std::vector<T> result;
+    result.reserve(this->size_);
+    for (Chunk* chunk{this->front_}; chunk != nullptr; chunk = chunk->next) {
+      result.insert(result.end(), chunk->Begin(), chunk->End());
+    }
+    return result;
+  }
+
+  Position Front() {
+    assert(this->size_ > 0);
+    return Position(this->front_, 0);
+  }
+  ConstPosition Front() const {
+    assert(this->size_ > 0);
+    return Position(this->front_, 0);
+  }
+  Position Back() {
+    assert(this->size_ > 0);
+    return Position(this->back_, this->back_->size - 1);
+  }
+  ConstPosition Back() const {
+    assert(this->size_ > 0);
+    return Position(this->back_, this->back_->size - 1);
+  }
+
+  void PushFront(const T& value) {
+    this->EmplaceFront(value);
+  }
+  void PushFront(T&& value) {
+    this->EmplaceFront(std::move(value));
+  }
+  void PushBack(const T& value) {
+    this->EmplaceBack(value);
+  }
+  void PushBack(T&& value) {
+    this->EmplaceBack(std::move(value));
+  }
+
+  void PopFront() {
+    this->Erase(this->Front());
+  }
+  void PopBack() {
+    this->Erase(this->Back());
+  }
+
+  // Both return the position of the new element.
+  template<typename U>
+  Position InsertBefore(Position element, U&& value) {
+    return this->Insert(element.chunk_, element.index_,
+                        std::forward<U>(value));
+  }
+  template<typename U>
+  Position InsertAfter(Position element, U&& value) {
+    return this->Insert(element.chunk_, element.index_ + 1,
+                        std::forward<U>(value));
+  }
+  // Returns the position of the next element, which is invalid for the
+  // last one.
+  Position Erase(Position element);
+
+  int Find(const T& value) const {
+    int position{0};
+    for (Chunk* chunk{this->front_}; chunk != nullptr; chunk = chunk->next) {
+      T* found{std::find(chunk->Begin(), chunk->End(), value)};
+      if (found != chunk->End()) {
+        return position + static_cast<int>(found - chunk->Begin());
+      }
+      position += chunk->size;
+    }
+    return -1;
+  }
+  std::vector<int> FindAll(const T& value) const {
+    std::vector<int> result;
+    int position{0};
+    for (Chunk* chunk{this->front_}; chunk != nullptr; chunk = chunk->next) {
+      for (int i{0}; i < chunk->size; ++i) {
+        if (chunk->Begin()[i] == value) {
+          result.push_back(position + i);
+        }
+      }
+      position += chunk->size;
+    }
+    return result;
+  }
+
+  Position operator[](int index) {
+    return this->Locate(index);
+  }
+  ConstPosition operator[](int index) const {
+    return this->Locate(index);
+  }
+
+  bool operator==(const UnrolledList& rhs) const {
+    if (this->size_ != rhs.size_) {
+      return false;
+    }
+    Chunk* rhs_chunk{rhs.front_};
+    int rhs_index{0};
+    for (Chunk* chunk{this->front_}; chunk != nullptr; chunk = chunk->next) {
+      for (int i{0}; i < chunk->size;) {
+        int count{std::min(chunk->size - i, rhs_chunk->size - rhs_index)};
+        if (!std::equal(chunk->Begin() + i, chunk->Begin() + i + count,
+                        rhs_chunk->Begin() + rhs_index)) {
+          return false;
+        }
+        i += count;
+        rhs_index += count;
+        if (rhs_index == rhs_chunk->size) {
+          rhs_chunk = rhs_chunk->next;
+          rhs_index = 0;
+        }
+      }
+    }
+    return true;
+  }
+  bool operator!=(const UnrolledList& rhs) const {
+    return !(*this == rhs);
+  }
+
+ private:
+  NodePool<Chunk, Allocator> pool_;
+  Chunk* front_{nullptr};
+  Chunk* back_{nullptr};
+
+  int size_{0};
+
+  void ReleaseMemory() {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (Chunk* chunk{this->front_}; chunk != nullptr;
+           chunk = chunk->next) {
+        std::destroy(chunk->Begin(), chunk->End());
+      }
+    }
+    this->pool_.Release();
+    this->ResetFields();
+  }
+  void ResetFields() {
+    this->front_ = nullptr;
+    this->back_ = nullptr;
+    this->size_ = 0;
+  }
+  void CopyFieldsFrom(const UnrolledList& source) {
+    this->front_ = source.front_;
+    this->back_ = source.back_;
+    this->size_ = source.size_;
+  }
+  // The copy packs its chunks full.
+  void CopyFrom(const UnrolledList& source) {
+    for (Chunk* chunk{source.front_}; chunk != nullptr; chunk = chunk->next) {
+      for (T* value{chunk->Begin()}; value != chunk->End(); ++value) {
+        this->EmplaceBack(*value);
+      }
+    }
+  }
+
+  // A new chunk whose elements will start at the given slot.
+  Chunk* NewChunk(Chunk* prev, Chunk* next, int first) {
+    Chunk* chunk{this->pool_.New()};
+    chunk->prev = prev;
+    chunk->next = next;
+    chunk->first = first;
+    (prev ? prev->next : this->front_) = chunk;
+    (next ? next->prev : this->back_) = chunk;
+    return chunk;
+  }
+  void DeleteChunk(Chunk* chunk) {
+    (chunk->prev ? chunk->prev->next : this->front_) = chunk->next;
+    (chunk->next ? chunk->next->prev : this->back_) = chunk->prev;
+    this->pool_.Delete(chunk);
+  }
+  // Moves the elements of the chunk to start at the given slot.
+  static void MoveWindow(Chunk* chunk, int first) {
+    T* from{chunk->Begin()};
+    T* to{chunk->Slots() + first};
+    if (to < from) {
+      for (int i{0}; i < chunk->size; ++i) {
+        std::construct_at(to + i, std::move(from[i]));
+        std::destroy_at(from + i);
+      }
+    } else if (to > from) {
+      for (int i{chunk->size - 1}; i >= 0; --i) {
+        std::construct_at(to + i, std::move(from[i]));
+        std::destroy_at(from + i);
+      }
+    }
+    chunk->first = first;
+  }
+  // Moves count elements from the front of one chunk to the back of the
+  // previous one, or with kFromBack, from the back of one chunk to the
+  // front of the next one.
+  template<bool kFromBack>
+  static void Shift(Chunk* from, Chunk* to, int count) {
+    if constexpr (kFromBack) {
+      MoveWindow(to, kCapacity - to->size);
+      to->first -= count;
+      std::uninitialized_move(from->End() - count, from->End(), to->Begin());
+      std::destroy(from->End() - count, from->End());
+    } else {
+      MoveWindow(to, 0);
+      std::uninitialized_move(from->Begin(), from->Begin() + count, to->End());
+      std::destroy(from->Begin(), from->Begin() + count);
+      from->first += count;
+    }
+    from->size -= count;
+    to->size += count;
+  }
+
+  template<typename... Ts>
+  void EmplaceFront(Ts&&... args) {
+    if (!this->front_ || this->front_->first == 0) {
+      this->NewChunk(nullptr, this->front_, kCapacity);
+    }
+    std::construct_at(this->front_->Begin() - 1, std::forward<Ts>(args)...);
+    --this->front_->first;
+    ++this->front_->size;
+    ++this->size_;
+  }
+  template<typename... Ts>
+  void EmplaceBack(Ts&&... args) {
+    if (!this->back_ ||
+        this->back_->first + this->back_->size == kCapacity) {
+      this->NewChunk(this->back_, nullptr, 0);
+    }
+    std::construct_at(this->back_->End(), std::forward<Ts>(args)...);
+    ++this->back_->size;
+    ++this->size_;
+  }
+  // Inserts at the given index within the chunk, splitting it when full.
+  template<typename U>
+  Position Insert(Chunk* chunk, int index, U&& value);
+  // Refills a chunk that has become sparse from a neighbour or merges the
+  // two.
+  void Refill(Chunk* chunk);
+
+  [[nodiscard]] Position Locate(int index) const {
+    assert(index >= 0 && index < this->size_);
+    if (index < this->size_ / 2) {
+      Chunk* chunk{this->front_};
+      for (; index >= chunk->size; chunk = chunk->next) {
+        index -= chunk->size;
+      }
+      return Position(chunk, index);
+    }
+    index = this->size_ - 1 - index;
+    Chunk* chunk{this->back_};
+    for (; index >= chunk->size; chunk = chunk->prev) {
+      index -= chunk->size;
+    }
+    return Position(chunk, chunk->size - 1 - index);
+  }
+};
+template<typename T, typename Allocator>
+template<typename U>
+typename UnrolledList<T, Allocator>::Position
+UnrolledList<T, Allocator>::Insert(Chunk* chunk, int index, U&& value) {
+  if (chunk->size == kCapacity) {
+    Chunk* half{this->NewChunk(chunk, chunk->next, 0)};
+    Shift<true>(chunk, half, kCapacity / 2);
+    if (index > chunk->size) {
+      index -= chunk->size;
+      chunk = half;
+    }
+  }
+  // The elements on the shorter side of the index make room, if the chunk
+  // has room on that side.
+  bool room_in_front{chunk->first > 0};
+  bool room_in_back{chunk->first + chunk->size < kCapacity};
+  T* begin{chunk->Begin()};
+  if (room_in_front && (!room_in_back || index < chunk->size / 2)) {
+    std::construct_at(begin - 1, std::forward<U>(value));
+    std::rotate(begin - 1, begin, begin + index);
+    --chunk->first;
+  } else {
+    std::construct_at(begin + chunk->size, std::forward<U>(value));
+    std::rotate(begin + index, begin + chunk->size, begin + chunk->size + 1);
+  }
+  ++chunk->size;
+  ++this->size_;
+  return Position(chunk, index);
+}
+template<typename T, typename Allocator>
+typename UnrolledList<T, Allocator>::Position UnrolledList<T, Allocator>::Erase(
+    Position element) {
+  Chunk* chunk{element.chunk_};
+  int index{element.index_};
+  T* begin{chunk->Begin()};
+  if (index < chunk->size / 2) {
+    std::rotate(begin, begin + index, begin + index + 1);
+    std::destroy_at(begin);
+    ++chunk->first;
+  } else {
+    std::rotate(begin + index, begin + index + 1, begin + chunk->size);
+    std::destroy_at(begin + chunk->size - 1);
+  }
+  --chunk->size;
+  --this->size_;
+  if (chunk->size == 0) {
+    Chunk* next{chunk->next};
+    this->DeleteChunk(chunk);
+    return Position(next, 0);
+  }
+  if (chunk->size >= kCapacity / 4 || (!chunk->prev && !chunk->next)) {
+    return index < chunk->size ? Position(chunk, index)
+                               : Position(chunk->next, 0);
+  }
+  // Refilling moves the elements, so the position is found by the number of
+  // elements that precede it in the two chunks.
+  Chunk* left{chunk->next ? chunk : chunk->prev};
+  int offset{(left == chunk ? 0 : left->size) + index};
+  this->Refill(chunk);
+  for (; left && offset >= left->size; left = left->next) {
+    offset -= left->size;
+  }
+  return Position(left, left ? offset : 0);
+}
+template<typename T, typename Allocator>
+void UnrolledList<T, Allocator>::Refill(Chunk* chunk) {
+  Chunk* left{chunk->next ? chunk : chunk->prev};
+  Chunk* right{left->next};
+  int total{left->size + right->size};
+  if (total <= kCapacity) {
+    Shift<false>(right, left, right->size);
+    this->DeleteChunk(right);
+  } else if (left->size < total / 2) {
+    Shift<false>(right, left, total / 2 - left->size);
+  } else {
+    Shift<true>(left, right, left->size - total / 2);
+  }
+}
+
+}  // namespace containers
+
+#endif  // UNROLLED_LIST_H_
@@ -5,19 +5,22 @@
 
 namespace pointers {
 
-template<typename T>
-class WeakPtr : public GeneralPtr<T> {
+template<typename T, typename Policy = NonAtomicPolicy>
+class WeakPtr : public GeneralPtr<T, Policy> {
  public:
   WeakPtr() = default;
-  explicit WeakPtr(const SharedPtr<T>& source) {
+  explicit WeakPtr(const SharedPtr<T, Policy>& source) {
     this->CopyPointersFrom(source);
-    ++this->counter_->weak_use_count;
+    if (this->counter_ != nullptr) {
+      Policy::Increment(this->counter_->weak_use_count);
+    }
   }
   WeakPtr(const WeakPtr& source) {
     *this = source;
   }
   WeakPtr(WeakPtr&& source) noexcept {
-    *this = std::move(source);
+    this->CopyPointersFrom(source);
+    source.Unbind();
   }
   ~WeakPtr() override {
     this->SafeDelete();
@@ -29,7 +32,9 @@ class WeakPtr : public GeneralPtr<T> {
     }
     this->SafeDelete();
     this->CopyPointersFrom(rhs);
-    ++this->counter_->weak_use_count;
+    if (this->counter_ != nullptr) {
+      Policy::Increment(this->counter_->weak_use_count);
+    }
     return *this;
   }
   WeakPtr& operator=(WeakPtr&& rhs) noexcept {
@@ -47,14 +52,17 @@ class WeakPtr : public GeneralPtr<T> {
   }
 
   [[nodiscard]] bool Expired() const {
-    return this->ptr_ == nullptr || this->counter_->use_count == 0;
+    return this->counter_ == nullptr ||
+           Policy::Load(this->counter_->use_count) == 0;
   }
 
-  SharedPtr<T> Lock() const {
-    if (this->Expired()) {
-      return SharedPtr<T>();
+  // Counts the new use only if the object is still alive at that moment.
+  SharedPtr<T, Policy> Lock() const {
+    if (this->counter_ == nullptr ||
+        !Policy::IncrementIfNonZero(this->counter_->use_count)) {
+      return SharedPtr<T, Policy>();
     }
-    return SharedPtr<T>(this->ptr_, this->counter_);
+    return SharedPtr<T, Policy>(this->ptr_, this->counter_);
   }
 
  private:
@@ -62,9 +70,8 @@ class WeakPtr : public GeneralPtr<T> {
     if (this->counter_ == nullptr) {
       return;
     }
-    --this->counter_->weak_use_count;
-    if (this->counter_->use_count == 0 && this->counter_->weak_use_count == 0) {
-      delete this->counter_;
+    if (Policy::Decrement(this->counter_->weak_use_count) == 0) {
+      this->counter_->Deallocate();
     }
     this->Unbind();
   }